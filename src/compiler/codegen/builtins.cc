@@ -31,6 +31,23 @@ namespace verona::compiler
         return builtin_freeze();
       else if (method == "trace")
         return builtin_trace_region();
+      else if (method == "region_objects")
+        return builtin_region_stat(bytecode::RegionStatistic::Objects);
+      else if (method == "region_live_bytes")
+        return builtin_region_stat(bytecode::RegionStatistic::LiveBytes);
+      else if (method == "region_arenas")
+        return builtin_region_stat(bytecode::RegionStatistic::Arenas);
+      else if (method == "region_arena_bytes")
+        return builtin_region_stat(bytecode::RegionStatistic::ArenaBytes);
+      else if (method == "region_arena_fragmentation")
+        return builtin_region_stat(
+          bytecode::RegionStatistic::ArenaFragmentation);
+      else if (method == "region_large_bytes")
+        return builtin_region_stat(bytecode::RegionStatistic::LargeBytes);
+      else if (method == "region_remembered_set")
+        return builtin_region_stat(bytecode::RegionStatistic::RememberedSet);
+      else if (method == "region_external_refs")
+        return builtin_region_stat(bytecode::RegionStatistic::ExternalRefs);
     }
     else if (entity == "U64")
     {
@@ -135,6 +152,20 @@ namespace verona::compiler
     gen_.opcode(Opcode::Return);
   }
 
+  void BuiltinGenerator::builtin_region_stat(bytecode::RegionStatistic stat)
+  {
+    assert(abi_.arguments == 2);
+    assert(abi_.returns == 1);
+
+    gen_.opcode(Opcode::RegionStat);
+    gen_.reg(Register(0));
+    gen_.reg(Register(1));
+    gen_.u8(static_cast<uint8_t>(stat));
+    gen_.opcode(Opcode::Clear);
+    gen_.reg(Register(1));
+    gen_.opcode(Opcode::Return);
+  }
+
   void BuiltinGenerator::builtin_binop(bytecode::BinaryOperator op)
   {
     assert(abi_.arguments == 2);
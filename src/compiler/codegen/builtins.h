@@ -25,6 +25,7 @@ namespace verona::compiler
     void builtin_print();
     void builtin_freeze();
     void builtin_trace_region();
+    void builtin_region_stat(bytecode::RegionStatistic stat);
     void builtin_binop(bytecode::BinaryOperator op);
     void builtin_cown_create();
     void builtin_cown_create_sleeping();
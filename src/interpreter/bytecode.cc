@@ -68,4 +68,38 @@ namespace verona::bytecode
     }
     return out;
   }
+
+  std::ostream& operator<<(std::ostream& out, const RegionStatistic& self)
+  {
+    switch (self)
+    {
+      case RegionStatistic::Objects:
+        fmt::print(out, "OBJECTS");
+        break;
+      case RegionStatistic::LiveBytes:
+        fmt::print(out, "LIVE_BYTES");
+        break;
+      case RegionStatistic::Arenas:
+        fmt::print(out, "ARENAS");
+        break;
+      case RegionStatistic::ArenaBytes:
+        fmt::print(out, "ARENA_BYTES");
+        break;
+      case RegionStatistic::ArenaFragmentation:
+        fmt::print(out, "ARENA_FRAGMENTATION");
+        break;
+      case RegionStatistic::LargeBytes:
+        fmt::print(out, "LARGE_BYTES");
+        break;
+      case RegionStatistic::RememberedSet:
+        fmt::print(out, "REMEMBERED_SET");
+        break;
+      case RegionStatistic::ExternalRefs:
+        fmt::print(out, "EXTERNAL_REFS");
+        break;
+
+        EXHAUSTIVE_SWITCH;
+    }
+    return out;
+  }
 }
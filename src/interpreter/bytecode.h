@@ -169,6 +169,7 @@ namespace verona::bytecode
     NewRegion, // dst(u8), descriptor(u8)
     NewSleepingCown, // dst(u8), descriptor(u8)
     Print, // format(u8), argc(u8), args(u8)...
+    RegionStat, // dst(u8), region(u8), stat(u8)
     Return,
     Store, // dst(u8), base(u8), selector(u32), src(u8)
     TraceRegion, // region(u8)
@@ -199,6 +200,24 @@ namespace verona::bytecode
     maximum_value = Or,
   };
 
+  /**
+   * Statistics that the RegionStat opcode can read from a region. These match
+   * the fields of the runtime's RegionStats.
+   */
+  enum class RegionStatistic : uint8_t
+  {
+    Objects,
+    LiveBytes,
+    Arenas,
+    ArenaBytes,
+    ArenaFragmentation,
+    LargeBytes,
+    RememberedSet,
+    ExternalRefs,
+
+    maximum_value = ExternalRefs,
+  };
+
   template<typename... Args>
   struct OpcodeOperands
   {};
@@ -345,6 +364,13 @@ namespace verona::bytecode
     constexpr static std::string_view format = "PRINT {}, {}";
   };
 
+  template<>
+  struct OpcodeSpec<Opcode::RegionStat>
+  {
+    using Operands = OpcodeOperands<Register, Register, RegionStatistic>;
+    constexpr static std::string_view format = "REGION_STAT {}, {}, {}";
+  };
+
   template<>
   struct OpcodeSpec<Opcode::Store>
   {
@@ -389,4 +415,5 @@ namespace verona::bytecode
 
   std::ostream& operator<<(std::ostream& out, const Register& self);
   std::ostream& operator<<(std::ostream& out, const BinaryOperator& self);
+  std::ostream& operator<<(std::ostream& out, const RegionStatistic& self);
 }
@@ -425,6 +425,37 @@ namespace verona::interpreter
     fmt::vprint(fmt, store);
   }
 
+  Value
+  VM::opcode_region_stat(const Value& object, bytecode::RegionStatistic stat)
+  {
+    check_type(object, {Value::ISO, Value::MUT});
+
+    VMObject* region = object->object->region();
+    rt::RegionStats stats = rt::Region::get_stats(region);
+
+    switch (stat)
+    {
+      case bytecode::RegionStatistic::Objects:
+        return Value::u64(stats.objects);
+      case bytecode::RegionStatistic::LiveBytes:
+        return Value::u64(stats.live_bytes);
+      case bytecode::RegionStatistic::Arenas:
+        return Value::u64(stats.arenas);
+      case bytecode::RegionStatistic::ArenaBytes:
+        return Value::u64(stats.arena_bytes);
+      case bytecode::RegionStatistic::ArenaFragmentation:
+        return Value::u64(stats.arena_fragmentation());
+      case bytecode::RegionStatistic::LargeBytes:
+        return Value::u64(stats.large_bytes);
+      case bytecode::RegionStatistic::RememberedSet:
+        return Value::u64(stats.remembered_set);
+      case bytecode::RegionStatistic::ExternalRefs:
+        return Value::u64(stats.external_refs);
+
+        EXHAUSTIVE_SWITCH;
+    }
+  }
+
   void VM::opcode_return()
   {
     // Ensure that all registers (except the return values) have been cleared
@@ -482,8 +513,15 @@ namespace verona::interpreter
       fatal("Writing reference to incorrect region");
     }
 
+    bool mut = src.tag == Value::Tag::MUT;
     Value old_value =
       object->fields[index].exchange(alloc_, object->region(), std::move(src));
+
+    // A generational collection needs to know which objects may refer to the
+    // nursery.
+    if (mut)
+      rt::RegionTrace::write_barrier(alloc_, object->region(), object);
+
     return std::move(old_value);
   }
 
@@ -590,6 +628,7 @@ namespace verona::interpreter
       OP(NewSleepingCown, opcode_new_sleeping_cown);
       OP(NewCown, opcode_new_cown);
       OP(Print, opcode_print);
+      OP(RegionStat, opcode_region_stat);
       OP(Return, opcode_return);
       OP(Store, opcode_store);
       OP(String, opcode_string);
@@ -43,6 +43,14 @@ namespace verona::rt
   struct has_finaliser<T, std::void_t<decltype(&T::finaliser)>> : std::true_type
   {};
 
+  template<class T, class = void>
+  struct has_batch_budget : std::false_type
+  {};
+  template<class T>
+  struct has_batch_budget<T, std::void_t<decltype(&T::batch_budget)>>
+  : std::true_type
+  {};
+
   template<class T>
   struct has_destructor
   {
@@ -94,6 +102,14 @@ namespace verona::rt
       ((T*)o)->~T();
     }
 
+    static constexpr uint64_t get_batch_budget()
+    {
+      if constexpr (has_batch_budget<T>::value)
+        return T::batch_budget;
+      else
+        return 0;
+    }
+
     static const Descriptor* desc()
     {
       static constexpr Descriptor desc = {
@@ -102,7 +118,8 @@ namespace verona::rt
         has_trace_possibly_iso<T>::value ? gc_trace_possibly_iso : nullptr,
         has_finaliser<T>::value ? gc_final : nullptr,
         has_notified<T>::value ? gc_notified : nullptr,
-        has_destructor<T>::value ? gc_destructor : nullptr};
+        has_destructor<T>::value ? gc_destructor : nullptr,
+        get_batch_budget()};
 
       return &desc;
     }
@@ -151,6 +168,34 @@ namespace verona::rt
         return Cown::alloc<sizeof(T)>(alloc, desc(), get_alloc_epoch());
     }
 
+    /**
+     * Returns what the region whose Iso object is this object holds. For a
+     * cown, returns the total over the regions its fields refer to, not
+     * counting their subregions, and must only be called by a behaviour
+     * running on the cown.
+     **/
+    RegionStats region_stats()
+    {
+      if constexpr (std::is_same_v<Base, Object>)
+      {
+        return Region::get_stats(this);
+      }
+      else
+      {
+        RegionStats stats;
+        ObjectStack st(ThreadAlloc::get());
+        Base::trace(st);
+
+        while (!st.empty())
+        {
+          Object* p = st.pop();
+          if (p->get_class() == Object::ISO)
+            stats += Region::get_stats(p);
+        }
+        return stats;
+      }
+    }
+
     void operator delete(void*)
     {
       // Should not be called directly, present to allow calling if the
@@ -69,9 +69,15 @@ namespace verona::rt
           auto& key = key_of(entry);
           if (key != 0)
           {
+            // Keep the mark, as a region may be swept incrementally, with
+            // entries inserted between the mark and the sweep.
+            bool marked = (key & MARK) != 0;
             key = (size_t)get_unmarked_pointer(key);
-            size_t dummy;
-            insert(alloc, *entry, dummy);
+            size_t location;
+            insert(alloc, *entry, location);
+
+            if (marked)
+              key_of(&set[location]) |= MARK;
           }
         }
 
@@ -220,6 +226,14 @@ namespace verona::rt
       return (Object*)(p & POINTER_MASK);
     }
 
+    /**
+     * Number of entries in the map.
+     */
+    size_t size() const
+    {
+      return count;
+    }
+
     Iterator begin()
     {
       Iterator i{this, 0};
@@ -113,6 +113,9 @@ namespace verona::rt
     FinalFunction finaliser;
     NotifiedFunction notified = nullptr;
     DestructorFunction destructor = nullptr;
+    // For cowns, the number of cycles to spend processing messages before
+    // yielding to the scheduler, or zero to use the runtime's default.
+    uint64_t batch_budget = 0;
     // TODO: virtual dispatch, pattern matching on type, reflection
   };
 
@@ -632,6 +635,31 @@ namespace verona::rt
       return true;
     }
 
+    /**
+     * Take `n` references at once. The caller must already hold one, so the
+     * count cannot be zero.
+     **/
+    inline void incref_many(size_t n)
+    {
+      assert((get_class() == RegionMD::RC) || (get_class() == RegionMD::COWN));
+      assert(debug_rc() != 0);
+
+      rc.fetch_add(n * ONE_RC);
+    }
+
+    /**
+     * Drop `n` references at once. The caller must hold more than `n`, so
+     * this is never the last one.
+     **/
+    inline void decref_many(size_t n)
+    {
+      assert((get_class() == RegionMD::RC) || (get_class() == RegionMD::COWN));
+
+      size_t prev_rc = rc.fetch_sub(n * ONE_RC);
+      assert(prev_rc > (size_t)get_class() + n * ONE_RC);
+      UNUSED(prev_rc);
+    }
+
     /**
      * Larger reference count than is possible to indicate that the cown's
      * reference count can no longer have new strong references taken out.
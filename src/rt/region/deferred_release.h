@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include "../object/object.h"
+
+#include <snmalloc.h>
+
+namespace verona::rt
+{
+  namespace scheduler
+  {
+    // This is used only to break a dependency cycle.
+    inline void unpause();
+  } // namespace scheduler
+
+  /**
+   * Releasing a large region or immutable graph can take a long time, and
+   * holds up whatever dropped the last reference to it. When enabled, large
+   * graphs are instead queued here and released by scheduler threads that
+   * have run out of other work.
+   *
+   * Queued graphs are split up as they are released, so that several idle
+   * threads can work on one graph: the subregions of a region are queued
+   * separately, and once `min_bytes` of an immutable graph has been freed,
+   * the SCCs still to be freed are queued separately.
+   *
+   * The bytes waiting to be released are capped. Beyond the cap, graphs are
+   * released straight away, so that memory use cannot run far ahead of
+   * reclamation. Immutable graphs are counted only by the size of the root of
+   * each queued SCC, as the rest of their size is unknown until they are
+   * freed.
+   **/
+  class DeferredRelease
+  {
+    friend class Region;
+    friend class RegionTrace;
+    friend class Immutable;
+
+  public:
+    struct Stats
+    {
+      // Graphs queued, including the parts of graphs split off.
+      size_t deferred = 0;
+      // Graphs released straight away because the cap was reached.
+      size_t over_cap = 0;
+      // Bytes queued and not yet released.
+      size_t queued_bytes = 0;
+      // The most bytes that have been queued at once.
+      size_t max_queued_bytes = 0;
+      // Bytes released by idle threads.
+      size_t released_bytes = 0;
+    };
+
+  private:
+    enum Kind
+    {
+      RegionGraph,
+      ImmutableGraph,
+    };
+
+    struct Node
+    {
+      Node* next;
+      Object* o;
+      size_t bytes;
+      Kind kind;
+    };
+
+    struct Policy
+    {
+      bool enabled = false;
+      size_t min_bytes = 256 * 1024;
+      size_t max_queued_bytes = 64 * 1024 * 1024;
+    };
+
+    struct State
+    {
+      std::atomic_flag lock = ATOMIC_FLAG_INIT;
+      std::atomic<Node*> head = nullptr;
+      Node* tail = nullptr;
+
+      // Set while the scheduler is running, so that there are threads to
+      // release what is queued.
+      std::atomic<bool> accepting = false;
+
+      // Graphs queued or being released.
+      std::atomic<size_t> outstanding = 0;
+
+      std::atomic<size_t> deferred = 0;
+      std::atomic<size_t> over_cap = 0;
+      std::atomic<size_t> queued_bytes = 0;
+      std::atomic<size_t> max_queued_bytes = 0;
+      std::atomic<size_t> released_bytes = 0;
+    };
+
+    static Policy& policy()
+    {
+      static Policy policy;
+      return policy;
+    }
+
+    static State& state()
+    {
+      static State state;
+      return state;
+    }
+
+  public:
+    /**
+     * Enable or disable releasing large graphs on idle threads. Graphs of at
+     * least `min_bytes` are deferred, while fewer than `max_queued_bytes` are
+     * waiting to be released.
+     **/
+    static void set_deferred_release(
+      bool enabled,
+      size_t min_bytes = 256 * 1024,
+      size_t max_queued_bytes = 64 * 1024 * 1024)
+    {
+      Systematic::cout() << "Set deferred release: " << enabled << " "
+                         << min_bytes << " " << max_queued_bytes << std::endl;
+      auto& p = policy();
+      p.enabled = enabled;
+      p.min_bytes = min_bytes;
+      p.max_queued_bytes = max_queued_bytes;
+    }
+
+    static bool get_deferred_release()
+    {
+      return policy().enabled;
+    }
+
+    static Stats get_stats()
+    {
+      auto& s = state();
+      Stats stats;
+      stats.deferred = s.deferred;
+      stats.over_cap = s.over_cap;
+      stats.queued_bytes = s.queued_bytes;
+      stats.max_queued_bytes = s.max_queued_bytes;
+      stats.released_bytes = s.released_bytes;
+      return stats;
+    }
+
+    /**
+     * Returns true if nothing is queued or being released.
+     **/
+    static bool is_idle()
+    {
+      return state().outstanding == 0;
+    }
+
+    static bool is_empty()
+    {
+      return state().head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    /**
+     * Called by the scheduler when it starts and stops running. Graphs are
+     * only deferred while there are scheduler threads to release them.
+     **/
+    static void set_accepting(bool accepting)
+    {
+      assert(accepting || is_idle());
+      state().accepting = accepting;
+    }
+
+    /**
+     * Release one queued graph, or part of it. Returns false if there was
+     * nothing to do. Called by scheduler threads when they are idle.
+     **/
+    static inline bool run_one(Alloc* alloc);
+
+  private:
+    /**
+     * Whether a graph of `bytes` should be deferred at all.
+     **/
+    static bool should_defer(size_t bytes)
+    {
+      auto& p = policy();
+      return p.enabled && (bytes >= p.min_bytes) && state().accepting;
+    }
+
+    /**
+     * Queue the region represented by the Iso object `o`, which uses `bytes`,
+     * if it is large enough. Returns false if it should be released straight
+     * away.
+     **/
+    static bool defer_region(Alloc* alloc, Object* o, size_t bytes)
+    {
+      return should_defer(bytes) && defer(alloc, o, bytes, RegionGraph);
+    }
+
+    /**
+     * Queue the graph `o` to be released by an idle thread. Returns false,
+     * and queues nothing, if it should be released straight away.
+     **/
+    static bool defer(Alloc* alloc, Object* o, size_t bytes, Kind kind)
+    {
+      auto& s = state();
+      size_t queued = s.queued_bytes.fetch_add(bytes) + bytes;
+
+      if (queued > policy().max_queued_bytes)
+      {
+        s.queued_bytes -= bytes;
+        s.over_cap++;
+        return false;
+      }
+
+      size_t max = s.max_queued_bytes;
+      while ((queued > max) &&
+             !s.max_queued_bytes.compare_exchange_weak(max, queued))
+      {}
+
+      Systematic::cout() << "Deferred release: " << o << " " << bytes
+                         << " bytes" << std::endl;
+
+      Node* n = (Node*)alloc->alloc<sizeof(Node)>();
+      n->next = nullptr;
+      n->o = o;
+      n->bytes = bytes;
+      n->kind = kind;
+
+      s.outstanding++;
+      s.deferred++;
+
+      {
+        FlagLock f(s.lock);
+        if (s.tail == nullptr)
+          s.head = n;
+        else
+          s.tail->next = n;
+        s.tail = n;
+      }
+
+      scheduler::unpause();
+      return true;
+    }
+
+    static Node* take()
+    {
+      auto& s = state();
+
+      if (s.head.load(std::memory_order_relaxed) == nullptr)
+        return nullptr;
+
+      FlagLock f(s.lock);
+      Node* n = s.head;
+      if (n != nullptr)
+      {
+        s.head = n->next;
+        if (s.head == nullptr)
+          s.tail = nullptr;
+      }
+      return n;
+    }
+
+    static void finished(size_t queued, size_t released)
+    {
+      auto& s = state();
+      s.queued_bytes -= queued;
+      s.released_bytes += released;
+      s.outstanding--;
+    }
+  };
+} // namespace verona::rt
@@ -196,6 +196,11 @@ namespace verona::rt
       alloc->dealloc<sizeof(ExternalMap)>(external_map);
     }
 
+    size_t external_ref_count() const
+    {
+      return external_map->size();
+    }
+
     void merge(Alloc* alloc, ExternalReferenceTable* that)
     {
       for (auto& e : *that->external_map)
@@ -210,6 +215,29 @@ namespace verona::rt
     {
       external_map->erase(p);
     }
+
+    /**
+     * Remove the entries for objects that a mark has left unmarked, so that
+     * their external references stop resolving before they are swept.
+     */
+    void erase_unmarked(Alloc* alloc)
+    {
+      // Erasing moves entries around, so find them all first.
+      ObjectStack dead(alloc);
+      for (auto& e : *external_map)
+      {
+        Object* p = ExternalMap::get_unmarked_pointer(e.first);
+        if (p->get_class() == Object::UNMARKED)
+          dead.push(p);
+      }
+
+      while (!dead.empty())
+      {
+        Object* p = dead.pop();
+        external_map->erase(p);
+        p->clear_has_ext_ref();
+      }
+    }
   };
 
   using ExternalRef = ExternalReferenceTable::ExternalRef;
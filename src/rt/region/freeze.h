@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include "freeze_tasks.h"
 #include "region.h"
 
 namespace verona::rt
@@ -116,10 +117,61 @@ namespace verona::rt
    * region. Rather than copy the set up front, we lazily construct it using the
    * ring in the isolated regions. Every time we break the ring, we keep track
    * of that point in the objects stack.
+   *
+   * Arena regions
+   * -------------
+   *
+   * Objects in an arena region cannot be deallocated one at a time, so an
+   * arena region is not split into SCCs. Instead, it is frozen in place as a
+   * single SCC whose root is the region metadata object, with a reference
+   * count of one for the reference to the entry point. Every object is made
+   * an `SCC_PTR` to the metadata object, and references out of the region
+   * are counted as above. The whole region is kept alive while any of its
+   * objects is referenced, and is freed a whole arena at a time, along with
+   * any unreachable objects it holds.
+   *
+   * A trace region that has adopted arenas, by having an arena region merged
+   * into it, is collected and then turned into an arena region, and frozen
+   * as one.
+   *
+   * Parallel freezing
+   * -----------------
+   *
+   * When enabled with `set_parallel_freeze`, and the scheduler is running, a
+   * freeze is spread over idle scheduler threads using `FreezeTasks`.
+   *
+   * Each subregion is frozen on its own: its objects can only refer to its
+   * own objects, to already immutable objects and cowns, and to the entry
+   * points of its own subregions. So its SCCs and reference counts do not
+   * depend on any other region, and large subregions are frozen by other
+   * threads while the current one carries on. The one incoming reference to
+   * a subregion's entry point is accounted for when that subregion is frozen.
+   *
+   * Within a large region, the walk of the objects stack that makes
+   * completed SCCs atomic and finds unreachable objects is split into slices.
+   * Each entry of the objects stack starts a chain of objects that no other
+   * entry reaches, so the slices touch disjoint objects. Finalisers are run,
+   * and unreachable objects deallocated, by the thread freezing the region,
+   * once every slice is finished, as before.
+   *
+   * The depth-first search within one region is still sequential.
    */
   class Freeze
   {
   private:
+    struct Policy
+    {
+      bool parallel = false;
+      size_t min_bytes = 1024 * 1024;
+      size_t slice_objects = 64 * 1024;
+    };
+
+    static Policy& policy()
+    {
+      static Policy policy;
+      return policy;
+    }
+
     static Object* post_order_mark(Object* o)
     {
       return (Object*)(((size_t)o) | 1);
@@ -131,206 +183,473 @@ namespace verona::rt
     }
 
   public:
+    /**
+     * Enable or disable spreading freezes over idle scheduler threads.
+     * Subregions using at least `min_bytes` are frozen by other threads, and
+     * the objects of a region are finished in slices of `slice_objects`.
+     **/
+    static void set_parallel_freeze(
+      bool parallel,
+      size_t min_bytes = 1024 * 1024,
+      size_t slice_objects = 64 * 1024)
+    {
+      Systematic::cout() << "Set parallel freeze: " << parallel << " "
+                         << min_bytes << " " << slice_objects << std::endl;
+      assert(slice_objects > 0);
+      auto& p = policy();
+      p.parallel = parallel;
+      p.min_bytes = min_bytes;
+      p.slice_objects = slice_objects;
+    }
+
+    static bool get_parallel_freeze()
+    {
+      return policy().parallel;
+    }
+
     static void apply(Alloc* alloc, Object* o)
     {
       assert(o->debug_is_iso());
 
-      ObjectStack objects(alloc);
-      ObjectStack dfs(alloc);
       ObjectStack iso(alloc);
-      ObjectStack pending(alloc);
+      FreezeTasks::Group subregions;
 
       iso.push(o);
 
       while (!iso.empty())
+        freeze_region(alloc, iso.pop(), iso, subregions);
+
+      // Wait for the subregions frozen by other threads.
+      FreezeTasks::wait(alloc, subregions);
+    }
+
+  private:
+    friend class FreezeTasks;
+
+    static bool is_parallel()
+    {
+      return policy().parallel && FreezeTasks::is_accepting();
+    }
+
+    /**
+     * Freeze the region with entry point `p`. Subregions that are found are
+     * either pushed on `iso`, or, if they are large, queued for other
+     * threads as part of `subregions`.
+     **/
+    static void freeze_region(
+      Alloc* alloc,
+      Object* p,
+      ObjectStack& iso,
+      FreezeTasks::Group& subregions)
+    {
+      assert(p->debug_is_iso());
+      RegionBase* r = p->get_region();
+
+      // Objects in the arenas a trace region has adopted cannot be freed one
+      // at a time once they are immutable, so such a region is collected and
+      // then frozen as an arena region.
+      if (
+        RegionTrace::is_trace_region(r) &&
+        (((RegionTrace*)r)->first_arena != nullptr))
       {
-        assert(objects.empty());
-        assert(dfs.empty());
+        RegionTrace::gc(alloc, p);
+        RegionTrace::convert_to_arena(alloc, p);
+      }
 
-        Object* p = iso.pop();
-        assert(p->debug_is_iso());
+      if (RegionArena::is_arena_region(p->get_region()))
+        freeze_arena(alloc, p, iso, subregions);
+      else
+        freeze_trace(alloc, p, iso, subregions);
+    }
 
-        // TODO(region): Right now we can only freeze trace regions. We'll
-        // probably need different strategies if we want to freeze other kinds
-        // of regions, e.g. copying objects out of an arena region.
-        assert(RegionTrace::is_trace_region(p->get_region()));
-        RegionTrace* reg = RegionTrace::get(p);
+    /**
+     * Freeze an arena region in place. All of its objects become a single
+     * SCC, whose root is the region metadata object, so no per-object
+     * reference counts are needed, and the arenas are freed whole when the
+     * SCC is released.
+     **/
+    static void freeze_arena(
+      Alloc* alloc,
+      Object* p,
+      ObjectStack& iso,
+      FreezeTasks::Group& subregions)
+    {
+      RegionArena* reg = RegionArena::get(p);
+      reg->freeze_begin(alloc, p);
 
-        // Drop the ISO mark on the entry point.
-        p->init_next(reg);
+      ObjectStack f(alloc);
 
-        // Start with the graph entry point.
-        dfs.push(p);
+      for (auto q : *reg)
+        freeze_arena_object(alloc, reg, q, f, iso, subregions);
 
-        // Add the finaliser, and non-finaliser rings to objects.
-        objects.push(reg->next_not_root);
-        objects.push(reg->get_next());
+      for (size_t i = 0; i < reg->frozen_large_count; i++)
+        freeze_arena_object(
+          alloc, reg, reg->frozen_large[i], f, iso, subregions);
 
-        // Mark region metadata object, so sweeping does not travel through it.
-        reg->Object::mark();
+      // Convert to atomic rc to allow sharing.
+      reg->make_atomic();
 
-        while (!dfs.empty())
-        {
-          Object::RegionMD c;
+      // References out of the region are now counted by the SCC.
+      reg->discard(alloc);
+      reg->dealloc_tables(alloc);
+    }
 
-          // Depth-first search has reached vertex q.
-          // This may be either a pre-order and post-order visit
-          Object* q_mark = dfs.pop();
-          Object* q = remove_post_order_mark(q_mark);
+    /**
+     * Add the object `q` of the arena region `reg` to the region's SCC, and
+     * account for its references out of the region.
+     **/
+    static void freeze_arena_object(
+      Alloc* alloc,
+      RegionArena* reg,
+      Object* q,
+      ObjectStack& f,
+      ObjectStack& iso,
+      FreezeTasks::Group& subregions)
+    {
+      // Clear the `has_ext_ref` bit.
+      q->clear_has_ext_ref();
+      q->set_scc(reg);
+      q->trace(f);
 
-          if (q != q_mark)
+      while (!f.empty())
+      {
+        Object* w = f.pop();
+        Object::RegionMD c;
+        Object* r = w->root_and_class(c);
+
+        switch (c)
+        {
+          case Object::UNMARKED:
+          case Object::NONATOMIC_RC:
           {
-            // Finished this part of the spanning tree
-            // If this is the head of the pending list, this means we have
-            // processed all children in the spanning tree and this should now
-            // be turned into a complete SCC with ref count 1.
-            if (q == pending.peek())
-            {
-              pending.pop();
-              q->root_and_class(c)->make_nonatomic_scc();
-              assert(c == Object::PENDING);
-            }
-            continue;
+            // Another object in this region, whether or not it has been
+            // added to the SCC yet.
+            assert((c == Object::UNMARKED) || (r == reg));
+            break;
           }
 
-          auto r = q->root_and_class(c);
+          case Object::ISO:
+          {
+            // External Iso, process that later, or on another thread if it
+            // is large.
+            if (!share_region(alloc, w, subregions))
+              iso.push(w);
+            break;
+          }
 
-          switch (c)
+          case Object::RC:
+          case Object::COWN:
           {
-            case Object::PENDING:
-            {
-              // We have found a reference back into one of the SCCs
-              // on the current path.  Collapse the path by unioning
-              // all the nodes up to that SCC.
-              auto rank = r->pending_rank();
-              while (r != (p = pending.peek()->root_and_class(c)))
-              {
-                assert(c == Object::PENDING);
-                // Rank used to keep the union/find data structure balanced
-                auto p_rank = p->pending_rank();
-                if (p_rank <= rank)
-                {
-                  p->set_scc(r);
-                  if (p_rank == rank)
-                    r->set_pending_rank(++rank);
-                }
-                else
-                {
-                  r->set_scc(p);
-                  rank = p_rank;
-                  r = p;
-                }
-                pending.pop();
-              }
-              break;
-            }
+            Systematic::cout()
+              << "External reference during freeze: " << r << std::endl;
+            // External reference
+            r->incref();
+            break;
+          }
 
-            case Object::ISO:
-            {
-              // External Iso, process that later.
-              iso.push(q);
-              break;
-            }
+          default:
+            assert(0);
+        }
+      }
+    }
 
-            case Object::RC:
-            case Object::COWN:
-            {
-              Systematic::cout()
-                << "External reference during freeze: " << r << std::endl;
-              // External reference
-              r->incref();
-              break;
-            }
+    /**
+     * Freeze a trace region, computing its SCCs as described above.
+     **/
+    static void freeze_trace(
+      Alloc* alloc,
+      Object* p,
+      ObjectStack& iso,
+      FreezeTasks::Group& subregions)
+    {
+      ObjectStack objects(alloc);
+      ObjectStack dfs(alloc);
+      ObjectStack pending(alloc);
 
-            case Object::NONATOMIC_RC:
-            {
-              // Reference to an already complete SCC, so incref it.
-              r->incref_nonatomic();
-              break;
-            }
+      RegionTrace::finish_gc(alloc, p);
+      RegionTrace* reg = RegionTrace::get(p);
 
-            case Object::UNMARKED:
-            {
-              // Lazily construct stack of sublists for gcing
-              objects.push(q->get_next());
-              // Clear the `has_ext_ref` bit.
-              q->clear_has_ext_ref();
-              // Add this to the current path we are exploring
-              q->set_pending();
-              pending.push(q);
-              // Push post-order mark, so we can revisit once subtree complete
-              dfs.push(post_order_mark(q));
-              // Add all the fields to the dfs
-              q->trace(dfs);
-              break;
-            }
+      // Drop the ISO mark on the entry point.
+      p->init_next(reg);
 
-            default:
-              assert(0);
-          }
-        }
+      // Start with the graph entry point.
+      dfs.push(p);
+
+      // Add the finaliser, and non-finaliser rings to objects.
+      objects.push(reg->next_not_root);
+      objects.push(reg->get_next());
+      size_t entries = 2;
+
+      // Mark region metadata object, so sweeping does not travel through it.
+      reg->Object::mark();
 
-        // Finalise all the objects
-        // Move non-atomics to atomics
-        // Calculate list of things to be deallocated
-        LinkedObjectStack to_dealloc;
-        p = objects.pop();
-        while (true)
+      while (!dfs.empty())
+      {
+        Object::RegionMD c;
+
+        // Depth-first search has reached vertex q.
+        // This may be either a pre-order and post-order visit
+        Object* q_mark = dfs.pop();
+        Object* q = remove_post_order_mark(q_mark);
+
+        if (q != q_mark)
         {
-          switch (p->get_class())
+          // Finished this part of the spanning tree
+          // If this is the head of the pending list, this means we have
+          // processed all children in the spanning tree and this should now
+          // be turned into a complete SCC with ref count 1.
+          if (q == pending.peek())
           {
-            case Object::UNMARKED:
-            {
-              // Node was unreachable deallocate it
-              auto next = p->get_next();
-
-              assert(p != reg);
+            pending.pop();
+            q->root_and_class(c)->make_nonatomic_scc();
+            assert(c == Object::PENDING);
+          }
+          continue;
+        }
 
-              p->finalise();
-              to_dealloc.push(p);
-              p = next;
-              continue;
-            }
+        auto r = q->root_and_class(c);
 
-            case Object::NONATOMIC_RC:
+        switch (c)
+        {
+          case Object::PENDING:
+          {
+            // We have found a reference back into one of the SCCs
+            // on the current path.  Collapse the path by unioning
+            // all the nodes up to that SCC.
+            auto rank = r->pending_rank();
+            while (r != (p = pending.peek()->root_and_class(c)))
             {
-              // Convert to atomic rc to allow sharing.
-              p->make_atomic();
-              break;
+              assert(c == Object::PENDING);
+              // Rank used to keep the union/find data structure balanced
+              auto p_rank = p->pending_rank();
+              if (p_rank <= rank)
+              {
+                p->set_scc(r);
+                if (p_rank == rank)
+                  r->set_pending_rank(++rank);
+              }
+              else
+              {
+                r->set_scc(p);
+                rank = p_rank;
+                r = p;
+              }
+              pending.pop();
             }
+            break;
+          }
 
-            case Object::MARKED:
-              assert(p == reg);
+          case Object::ISO:
+          {
+            // External Iso, process that later, or on another thread if it
+            // is large.
+            if (!share_region(alloc, q, subregions))
+              iso.push(q);
+            break;
+          }
 
-            case Object::RC:
-            case Object::SCC_PTR:
-              break;
+          case Object::RC:
+          case Object::COWN:
+          {
+            Systematic::cout()
+              << "External reference during freeze: " << r << std::endl;
+            // External reference
+            r->incref();
+            break;
+          }
 
-            default:
-              assert(0);
+          case Object::NONATOMIC_RC:
+          {
+            // Reference to an already complete SCC, so incref it.
+            r->incref_nonatomic();
+            break;
           }
 
-          if (objects.empty())
+          case Object::UNMARKED:
+          {
+            // Lazily construct stack of sublists for gcing
+            objects.push(q->get_next());
+            entries++;
+            // Clear the `has_ext_ref` bit.
+            q->clear_has_ext_ref();
+            // Add this to the current path we are exploring
+            q->set_pending();
+            pending.push(q);
+            // Push post-order mark, so we can revisit once subtree complete
+            dfs.push(post_order_mark(q));
+            // Add all the fields to the dfs
+            q->trace(dfs);
             break;
+          }
+
+          default:
+            assert(0);
+        }
+      }
+
+      // Finalise all the objects
+      // Move non-atomics to atomics
+      // Calculate list of things to be deallocated
+      LinkedObjectStack to_dealloc;
+      FreezeTasks::Group slices;
+      FreezeTasks::Task* shared = nullptr;
+      size_t slice = policy().slice_objects;
 
-          p = objects.pop();
+      if (is_parallel())
+      {
+        // Leave the last slice for this thread.
+        while (entries > slice)
+        {
+          auto t = FreezeTasks::make_slice(alloc, slices, slice);
+          for (size_t i = 0; i < slice; i++)
+            t->entries()[i] = objects.pop();
+          entries -= slice;
+
+          t->next_slice = shared;
+          shared = t;
+          FreezeTasks::push(t);
         }
+      }
+
+      while (!objects.empty())
+        finish_chain(objects.pop(), to_dealloc);
 
-        // Finally deallocate objects.
-        while (!to_dealloc.empty())
+      if (shared != nullptr)
+      {
+        FreezeTasks::wait(alloc, slices);
+
+        while (shared != nullptr)
         {
-          Object* q = to_dealloc.pop();
-          q->destructor();
-          q->dealloc(alloc);
+          auto t = shared;
+          shared = t->next_slice;
+
+          while (!t->garbage.empty())
+            to_dealloc.push(t->garbage.pop());
+
+          alloc->dealloc(t, FreezeTasks::slice_size(t->count));
         }
+      }
+
+      to_dealloc.forall<finalise>();
 
-        reg->discard(alloc);
-        reg->dealloc(alloc);
+      // Finally deallocate objects.
+      while (!to_dealloc.empty())
+      {
+        Object* q = to_dealloc.pop();
+        assert(q != reg);
+        q->destructor();
+        q->dealloc(alloc);
       }
 
+      reg->discard(alloc);
+      reg->dealloc(alloc);
+
       assert(objects.empty());
       assert(dfs.empty());
-      assert(iso.empty());
+    }
+
+    /**
+     * Queue the subregion with entry point `q` to be frozen by another
+     * thread, if it is large enough. Returns false if it should be frozen by
+     * this thread.
+     **/
+    static bool share_region(
+      Alloc* alloc, Object* q, FreezeTasks::Group& subregions)
+    {
+      if (!is_parallel() || (region_memory(q) < policy().min_bytes))
+        return false;
+
+      Systematic::cout() << "Sharing freeze of region: " << q << std::endl;
+      FreezeTasks::push(FreezeTasks::make_region(alloc, subregions, q));
+      return true;
+    }
+
+    /**
+     * The bytes used by the region with entry point `q`.
+     **/
+    static size_t region_memory(Object* q)
+    {
+      RegionBase* r = q->get_region();
+      if (RegionArena::is_arena_region(r))
+        return ((RegionArena*)r)->arena_memory();
+
+      return ((RegionTrace*)r)->current_memory_used;
+    }
+
+    /**
+     * Walk the chain of objects that starts with the objects stack entry
+     * `p`. Completed SCCs are made atomic, so that they can be shared, and
+     * unreachable objects are added to `garbage`.
+     **/
+    static void finish_chain(Object* p, LinkedObjectStack& garbage)
+    {
+      while (true)
+      {
+        switch (p->get_class())
+        {
+          case Object::UNMARKED:
+          {
+            // Node was unreachable deallocate it
+            auto next = p->get_next();
+            garbage.push(p);
+            p = next;
+            continue;
+          }
+
+          case Object::NONATOMIC_RC:
+          {
+            // Convert to atomic rc to allow sharing.
+            p->make_atomic();
+            return;
+          }
+
+          // Only the region metadata object is marked.
+          case Object::MARKED:
+          case Object::RC:
+          case Object::SCC_PTR:
+            return;
+
+          default:
+            assert(0);
+            return;
+        }
+      }
+    }
+
+    static void finalise(Object* o)
+    {
+      o->finalise();
     }
   };
+
+  inline bool FreezeTasks::run_one(Alloc* alloc)
+  {
+    Task* t = take();
+    if (t == nullptr)
+      return false;
+
+    Group* group = t->group;
+
+    if (t->iso != nullptr)
+    {
+      Object* o = t->iso;
+      alloc->dealloc<sizeof(Task)>(t);
+
+      Systematic::cout() << "Running freeze of region: " << o << std::endl;
+
+      // Subregions of this region that are not shared are frozen here too.
+      ObjectStack iso(alloc);
+      iso.push(o);
+      while (!iso.empty())
+        Freeze::freeze_region(alloc, iso.pop(), iso, *group);
+    }
+    else
+    {
+      for (size_t i = 0; i < t->count; i++)
+        Freeze::finish_chain(t->entries()[i], t->garbage);
+    }
+
+    finished(group);
+    return true;
+  }
 } // namespace verona::rt
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include "../object/object.h"
+#include "linked_object_stack.h"
+
+#include <snmalloc.h>
+
+namespace verona::rt
+{
+  namespace scheduler
+  {
+    // These are used only to break a dependency cycle.
+    inline void unpause();
+    inline void yield();
+  } // namespace scheduler
+
+  /**
+   * Work shared out by a parallel `Freeze::apply`. Large subregions, and
+   * slices of a large region's objects, are queued here, and picked up by
+   * scheduler threads that have run out of other work.
+   *
+   * The thread that started the freeze never just waits: while tasks it
+   * depends on are unfinished, it takes queued tasks itself. Tasks never wait
+   * for anything other than tasks, so a freeze finishes even if no other
+   * thread helps.
+   **/
+  class FreezeTasks
+  {
+    friend class Freeze;
+
+  public:
+    /**
+     * Tasks that some part of a freeze must wait for.
+     **/
+    struct Group
+    {
+      std::atomic<size_t> outstanding = 0;
+    };
+
+  private:
+    struct Task
+    {
+      Task* next;
+      Group* group;
+
+      // The subregion to freeze, or nullptr if this is a slice.
+      Object* iso;
+
+      // For a slice, the entries of the region's objects stack to finish,
+      // and the unreachable objects found in them. The entries follow the
+      // task in the same allocation.
+      Task* next_slice;
+      size_t count;
+      LinkedObjectStack garbage;
+
+      Object** entries()
+      {
+        return (Object**)(this + 1);
+      }
+    };
+
+    struct State
+    {
+      std::atomic_flag lock = ATOMIC_FLAG_INIT;
+      std::atomic<Task*> head = nullptr;
+
+      // Set while the scheduler is running, so that there are threads to
+      // help.
+      std::atomic<bool> accepting = false;
+    };
+
+    static State& state()
+    {
+      static State state;
+      return state;
+    }
+
+  public:
+    static bool is_empty()
+    {
+      return state().head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    /**
+     * Called by the scheduler when it starts and stops running. Work is only
+     * shared while there are scheduler threads to help with it.
+     **/
+    static void set_accepting(bool accepting)
+    {
+      state().accepting = accepting;
+    }
+
+    /**
+     * Run one queued task. Returns false if there was nothing to do. Called
+     * by scheduler threads when they are idle.
+     **/
+    static inline bool run_one(Alloc* alloc);
+
+  private:
+    static bool is_accepting()
+    {
+      return state().accepting.load(std::memory_order_relaxed);
+    }
+
+    static Task* make_region(Alloc* alloc, Group& group, Object* iso)
+    {
+      Task* t = (Task*)alloc->alloc<sizeof(Task)>();
+      t->group = &group;
+      t->iso = iso;
+      t->next_slice = nullptr;
+      t->count = 0;
+      new (&t->garbage) LinkedObjectStack();
+      return t;
+    }
+
+    static Task* make_slice(Alloc* alloc, Group& group, size_t count)
+    {
+      Task* t = (Task*)alloc->alloc(slice_size(count));
+      t->group = &group;
+      t->iso = nullptr;
+      t->next_slice = nullptr;
+      t->count = count;
+      new (&t->garbage) LinkedObjectStack();
+      return t;
+    }
+
+    static size_t slice_size(size_t count)
+    {
+      return sizeof(Task) + (count * sizeof(Object*));
+    }
+
+    static void push(Task* t)
+    {
+      auto& s = state();
+      t->group->outstanding++;
+
+      {
+        FlagLock f(s.lock);
+        t->next = s.head;
+        s.head = t;
+      }
+
+      scheduler::unpause();
+    }
+
+    static Task* take()
+    {
+      auto& s = state();
+
+      if (s.head.load(std::memory_order_relaxed) == nullptr)
+        return nullptr;
+
+      FlagLock f(s.lock);
+      Task* t = s.head;
+      if (t != nullptr)
+        s.head = t->next;
+      return t;
+    }
+
+    /**
+     * Marks a task finished. This must be the last access to the task's
+     * group, as the waiting thread may then return.
+     **/
+    static void finished(Group* group)
+    {
+      group->outstanding--;
+    }
+
+    /**
+     * Run queued tasks until every task in `group` has finished.
+     **/
+    static void wait(Alloc* alloc, Group& group)
+    {
+      while (group.outstanding != 0)
+      {
+        if (!run_one(alloc))
+        {
+          scheduler::yield();
+          snmalloc::Aal::pause();
+        }
+      }
+    }
+  };
+} // namespace verona::rt
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "../object/object.h"
+#include "deferred_release.h"
 #include "linked_object_stack.h"
 
 namespace verona::rt
@@ -14,8 +15,17 @@ namespace verona::rt
     inline void mark_for_scan(Object* o, EpochMark epoch);
   } // namespace cown
 
+  namespace region
+  {
+    // This is used only to break a dependency cycle.
+    inline bool is_arena(Object* o);
+    inline size_t release_frozen_arena(Alloc* alloc, Object* o);
+  } // namespace region
+
   class Immutable
   {
+    friend class DeferredRelease;
+
   public:
     static void acquire(Object* o)
     {
@@ -81,15 +91,30 @@ namespace verona::rt
     static size_t free(Alloc* alloc, Object* o)
     {
       assert(o == o->immutable());
+
+      LinkedObjectStack dfs;
+      dfs.push(o);
+      return free_stack(alloc, dfs);
+    }
+
+    /**
+     * Free the SCCs in `dfs`, whose reference counts have dropped to zero,
+     * and everything that becomes unreachable as a result. Returns the number
+     * of bytes freed.
+     *
+     * If deferred release is enabled, this stops once enough has been freed
+     * to make the graph worth deferring, and queues the remaining SCCs to be
+     * freed by idle threads.
+     **/
+    static size_t free_stack(Alloc* alloc, LinkedObjectStack& dfs)
+    {
       size_t total = 0;
+      size_t last_split = 0;
 
       // Free immutable graph.
       ObjectStack f(alloc);
       LinkedObjectStack fl;
       LinkedObjectStack scc;
-      LinkedObjectStack dfs;
-
-      dfs.push(o);
 
       while (!dfs.empty())
       {
@@ -98,6 +123,20 @@ namespace verona::rt
         assert(scc.empty());
 
         Object* v = dfs.pop();
+
+        // A frozen arena region is a single SCC, freed all at once.
+        if (region::is_arena(v))
+        {
+          total += free_arena(alloc, v, f, dfs);
+
+          if (DeferredRelease::should_defer(total - last_split))
+          {
+            defer_stack(alloc, dfs);
+            last_split = total;
+          }
+          continue;
+        }
+
         v->trace(f);
 
         while (!f.empty())
@@ -134,6 +173,12 @@ namespace verona::rt
         total += v->size();
         v->destructor();
         v->dealloc(alloc);
+
+        if (DeferredRelease::should_defer(total - last_split))
+        {
+          defer_stack(alloc, dfs);
+          last_split = total;
+        }
       }
 
       assert(f.empty());
@@ -144,6 +189,64 @@ namespace verona::rt
       return total;
     }
 
+    /**
+     * Free the SCC of a frozen arena region, whose root is the region
+     * metadata object `v`. References to other SCCs are released, adding
+     * those whose reference counts drop to zero to `dfs`, and then the region
+     * is freed a whole arena at a time. Returns the number of bytes freed.
+     **/
+    static size_t free_arena(
+      Alloc* alloc, Object* v, ObjectStack& f, LinkedObjectStack& dfs)
+    {
+      ObjectStack objects(alloc);
+      LinkedObjectStack scc;
+
+      v->trace(objects);
+
+      while (!objects.empty())
+      {
+        objects.pop()->trace(f);
+
+        while (!f.empty())
+        {
+          Object* w = f.pop();
+          Object::RegionMD c;
+
+          // Ignore references within the region.
+          if (w->root_and_class(c) != v)
+            scc_classify(alloc, w, dfs, scc);
+        }
+      }
+
+      assert(scc.empty());
+      return region::release_frozen_arena(alloc, v);
+    }
+
+    /**
+     * Hand the SCCs in `dfs` to idle threads, until the cap on deferred
+     * memory is reached.
+     **/
+    static void defer_stack(Alloc* alloc, LinkedObjectStack& dfs)
+    {
+      while (!dfs.empty())
+      {
+        Object* v = dfs.pop();
+        if (!DeferredRelease::defer(
+              alloc, v, v->size(), DeferredRelease::ImmutableGraph))
+        {
+          dfs.push(v);
+          return;
+        }
+      }
+    }
+
+    static size_t free_deferred(Alloc* alloc, Object* o)
+    {
+      LinkedObjectStack dfs;
+      dfs.push(o);
+      return free_stack(alloc, dfs);
+    }
+
     static inline void run_finaliser(Object* o)
     {
       o->finalise();
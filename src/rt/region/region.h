@@ -167,16 +167,12 @@ namespace verona::rt
     static void release(Alloc* alloc, Object* o)
     {
       assert(o->debug_is_iso());
-      ObjectStack collect(alloc);
-      ObjectStack f(alloc);
-      Region::release_internal(alloc, o, f, collect);
 
-      while (!collect.empty())
-      {
-        o = collect.pop();
-        assert(o->debug_is_iso());
-        Region::release_internal(alloc, o, f, collect);
-      }
+      // A large region may be left to idle threads.
+      if (DeferredRelease::defer_region(alloc, o, memory_used(o)))
+        return;
+
+      release_now(alloc, o);
     }
 
     /**
@@ -191,6 +187,15 @@ namespace verona::rt
       return o->get_region();
     }
 
+    /**
+     * Returns what the region represented by the Iso object `o` holds, not
+     * counting its subregions. This takes constant time.
+     **/
+    static RegionStats get_stats(Object* o)
+    {
+      return get(o)->get_stats();
+    }
+
     /**
      * Iterate over the region represented by iso object 'o' and count the
      * number of objects (including `o`) within that region. Ignores
@@ -225,6 +230,44 @@ namespace verona::rt
     }
 
   private:
+    friend class DeferredRelease;
+
+    static void release_now(Alloc* alloc, Object* o)
+    {
+      ObjectStack collect(alloc);
+      ObjectStack f(alloc);
+      Region::release_internal(alloc, o, f, collect);
+
+      while (!collect.empty())
+      {
+        o = collect.pop();
+        assert(o->debug_is_iso());
+
+        // Large subregions may be released by other idle threads in parallel.
+        if (!DeferredRelease::defer_region(alloc, o, memory_used(o)))
+          Region::release_internal(alloc, o, f, collect);
+      }
+    }
+
+    /**
+     * Returns the memory used by the region represented by the Iso object
+     * `o`. Objects in the large object ring of an arena region are not
+     * counted.
+     **/
+    static size_t memory_used(Object* o)
+    {
+      RegionBase* r = o->get_region();
+      switch (Region::get_type(r))
+      {
+        case RegionType::Trace:
+          return ((RegionTrace*)r)->current_memory_used;
+        case RegionType::Arena:
+          return ((RegionArena*)r)->arena_memory();
+        default:
+          abort();
+      }
+    }
+
     /**
      * Trace the region's object graph, following external pointers to cowns,
      * immutables, and subregions. Note that this will find all cowns reachable
@@ -246,6 +289,11 @@ namespace verona::rt
       ObjectStack& recurse,
       EpochMark epoch)
     {
+      // Garbage left by an incremental collection may point at objects that
+      // have already been swept, so it must not be traced.
+      if constexpr (std::is_same_v<RegionType, RegionTrace>)
+        RegionTrace::finish_gc(alloc, o);
+
       // First, iterate over all objects and trace them.
       auto reg = RegionType::get(o);
       for (auto b : *reg)
@@ -318,4 +366,27 @@ namespace verona::rt
       }
     }
   };
+
+  inline bool DeferredRelease::run_one(Alloc* alloc)
+  {
+    Node* n = take();
+    if (n == nullptr)
+      return false;
+
+    Object* o = n->o;
+    size_t bytes = n->bytes;
+    Kind kind = n->kind;
+    alloc->dealloc<sizeof(Node)>(n);
+
+    Systematic::cout() << "Running deferred release: " << o << std::endl;
+
+    size_t released = bytes;
+    if (kind == RegionGraph)
+      Region::release_now(alloc, o);
+    else
+      released = Immutable::free_deferred(alloc, o);
+
+    finished(bytes, released);
+    return true;
+  }
 } // namespace verona::rt
@@ -11,6 +11,14 @@ namespace verona::rt
 {
   using namespace snmalloc;
 
+  class RegionArena;
+
+  namespace region
+  {
+    // This is used only to break a dependency cycle.
+    inline void merge_trace(Alloc* alloc, RegionArena* into, Object* o);
+  } // namespace region
+
   /**
    * Please see region.h for the full documentation.
    *
@@ -27,17 +35,38 @@ namespace verona::rt
    * then allocate the object within the new arena. Note that we do not do
    * first fit or best fit.
    *
+   * A region's first arena is small, and each new arena is twice the size of
+   * the last, up to `Arena::MAX_SIZE`. Most regions are short lived and
+   * small, so this keeps them from holding on to lots of unused memory.
+   *
    * Note that if the Iso is allocated within an arena, it will still point to
    * the arena region object.
    *
-   * Objects that are too large to be allocated within an arena are allocated
-   * by snmalloc and placed into the large object ring, a circular linked list
-   * of objects accessed via the Object::next pointer. This ring mixes both
-   * trivial and non-trivial objects. Since the iso object may not be in the
-   * large object ring, we need a pointer to the last object in the ring, to
-   * ensure merges are fast. If the iso object is in the large object ring,
-   * then it must be in the last position, so it can point to the region
-   * metadata object.
+   * Objects that are too large to be allocated within the region's next arena
+   * are allocated by snmalloc and placed into the large object ring, a
+   * circular linked list of objects accessed via the Object::next pointer.
+   * This ring mixes both trivial and non-trivial objects. Since the iso object
+   * may not be in the large object ring, we need a pointer to the last object
+   * in the ring, to ensure merges are fast. If the iso object is in the large
+   * object ring, then it must be in the last position, so it can point to the
+   * region metadata object. This is also how we tell whether the iso object is
+   * in an arena, as objects in arenas have a null next pointer.
+   *
+   * A trace region can be merged into an arena region, and the other way
+   * around, without copying objects. The objects of a trace region were each
+   * allocated separately, so they join the large object ring. A trace region
+   * adopts the arenas of an arena region whole, and still collects the
+   * objects in them one at a time. The memory of a collected object stays
+   * part of its arena until every object in the arena has been collected, so
+   * the object is left in place and marked dead, and is skipped when
+   * iterating over the region.
+   *
+   * An arena region is frozen in place, without copying its objects or
+   * giving each of them a reference count. All of its objects form a single
+   * SCC, whose root is the region metadata object, which is kept until the
+   * SCC is released. The objects' next pointers are then needed for the SCC,
+   * so the objects that were in the large object ring are kept in an array
+   * instead. Releasing the SCC frees the arenas whole.
    **/
   class RegionArena : public RegionBase
   {
@@ -49,13 +78,16 @@ namespace verona::rt
   private:
     friend class Region;
     friend class RegionTrace;
+    friend class Freeze;
+    friend size_t region::release_frozen_arena(Alloc* alloc, Object* o);
+    friend void region::merge_trace(Alloc* alloc, RegionArena* into, Object* o);
 
     /**
-     * An Arena is a large block of pre-allocated memory. It has an overhead of
-     * four pointers: the next Arena in the linked list, and three pointers to
-     * keep track of where objects are allocated. The next pointers of all
-     * objects inside an arena are set to nullptr. An initialized arena is
-     * guaranteed to have at least one object.
+     * An Arena is a block of pre-allocated memory, between `MIN_SIZE` and
+     * `MAX_SIZE` bytes. It has an overhead of four pointers: the next Arena in
+     * the linked list, and three pointers to keep track of where objects are
+     * allocated. The next pointers of all objects inside an arena are set to
+     * nullptr. An initialized arena is guaranteed to have at least one object.
      *
      * Trivial objects (ie. those with no destructor, no finaliser and no iso
      * fields) are allocated from the beginning of the arena, starting at
@@ -112,7 +144,22 @@ namespace verona::rt
       friend class RegionArena::iterator;
 
     public:
-      static constexpr size_t SIZE = 1024 * 1024 - 4 * sizeof(uintptr_t);
+      /**
+       * Size of the first arena in a region, including the header.
+       **/
+      static constexpr size_t MIN_SIZE = 4 * 1024;
+
+      /**
+       * Size that arenas stop growing at, including the header.
+       **/
+      static constexpr size_t MAX_SIZE = 1024 * 1024;
+
+      /**
+       * Space taken by the header, rounded up so that objects are aligned.
+       **/
+      static constexpr size_t HEADER_SIZE =
+        (4 * sizeof(uintptr_t) + Object::ALIGNMENT - 1) &
+        ~(Object::ALIGNMENT - 1);
 
       /**
        * Pointer to next arena in the linked list.
@@ -132,25 +179,55 @@ namespace verona::rt
       std::byte* non_trivial_begin;
 
       /**
-       * Pointer to the byte after the Arena. We technically don't need to
-       * store this pointer, but we have some space because `objects_begin`
-       * needs to be aligned.
+       * Pointer to the byte after the Arena, which also tells us its size.
        **/
       std::byte* non_trivial_end;
 
+      explicit Arena(size_t size)
+      : next(nullptr),
+        objects_end(objects_begin()),
+        non_trivial_begin((std::byte*)this + size),
+        non_trivial_end(non_trivial_begin)
+      {
+        assert(free_space() == capacity(size));
+      }
+
       /**
        * Where objects will actually be allocated.
        **/
-      alignas(Object::ALIGNMENT) std::byte objects_begin[SIZE];
+      inline std::byte* objects_begin() const
+      {
+        return (std::byte*)this + HEADER_SIZE;
+      }
 
     public:
-      Arena()
-      : next(nullptr),
-        objects_end(objects_begin),
-        non_trivial_begin(objects_begin + SIZE),
-        non_trivial_end(non_trivial_begin)
+      /**
+       * Allocate an arena of `size` bytes, including the header.
+       **/
+      static Arena* create(Alloc* alloc, size_t size)
+      {
+        assert(size >= MIN_SIZE && size <= MAX_SIZE);
+        void* p = alloc->alloc(size);
+        return new (p) Arena(size);
+      }
+
+      static void dealloc(Alloc* alloc, Arena* arena)
+      {
+        alloc->dealloc(arena, arena->size());
+      }
+
+      /**
+       * The space for objects in an arena of `size` bytes.
+       **/
+      static constexpr size_t capacity(size_t size)
       {
-        assert(free_space() == SIZE);
+        return size - HEADER_SIZE;
+      }
+
+      inline size_t size() const
+      {
+        std::ptrdiff_t diff = non_trivial_end - (std::byte*)this;
+        return (size_t)diff;
       }
 
       inline size_t free_space() const
@@ -196,13 +273,29 @@ namespace verona::rt
         return o;
       }
 
+      /**
+       * Returns true if `o`, an object in this arena, has been collected by
+       * the trace region that adopted the arena. A dead object points at its
+       * arena, which no live object in an arena does.
+       **/
+      inline bool is_dead(Object* o)
+      {
+        return (o->get_class() == Object::UNMARKED) &&
+          (o->get_next() == (Object*)this);
+      }
+
+      inline void set_dead(Object* o)
+      {
+        o->init_next((Object*)this);
+      }
+
     private:
       bool debug_invariant() const
       {
-        bool objects_ptrs = objects_begin <= objects_end;
+        bool objects_ptrs = objects_begin() <= objects_end;
         bool non_trivial_ptrs = non_trivial_begin <= non_trivial_end;
         bool no_overlap = (non_trivial_begin - objects_end) >= 0;
-        auto alignment1 = Object::debug_is_aligned(objects_begin);
+        auto alignment1 = Object::debug_is_aligned(objects_begin());
         auto alignment2 = Object::debug_is_aligned(objects_end);
         auto alignment3 = Object::debug_is_aligned(non_trivial_begin);
         auto alignment4 = Object::debug_is_aligned(non_trivial_end);
@@ -210,7 +303,7 @@ namespace verona::rt
           alignment2 && alignment3 && alignment4;
       }
     };
-    static_assert(sizeof(Arena) == 1024 * 1024 * sizeof(std::byte));
+    static_assert(sizeof(Arena) <= Arena::HEADER_SIZE);
 
     /**
      * Pointer to the linked list of arenas where objects are allocated in.
@@ -232,8 +325,28 @@ namespace verona::rt
      **/
     Object* last_large;
 
+    /**
+     * Size of the next arena to allocate. Doubles with each new arena, up to
+     * `Arena::MAX_SIZE`.
+     **/
+    size_t next_arena_size;
+
+    /**
+     * Once the region is frozen, the objects that were in the large object
+     * ring. May be null, if there were none.
+     **/
+    Object** frozen_large;
+    size_t frozen_large_count;
+    bool frozen;
+
     RegionArena()
-    : first_arena(nullptr), last_arena(nullptr), last_large(nullptr)
+    : first_arena(nullptr),
+      last_arena(nullptr),
+      last_large(nullptr),
+      next_arena_size(Arena::MIN_SIZE),
+      frozen_large(nullptr),
+      frozen_large_count(0),
+      frozen(false)
     {
       set_descriptor(desc());
       init_next(this);
@@ -242,11 +355,28 @@ namespace verona::rt
     static const Descriptor* desc()
     {
       static constexpr Descriptor desc = {
-        sizeof(RegionArena), nullptr, nullptr, nullptr};
+        sizeof(RegionArena), trace_frozen, nullptr, nullptr};
 
       return &desc;
     }
 
+    /**
+     * The region metadata object of a frozen region is the root of its SCC,
+     * and refers to every object in the region, so that scanning the SCC
+     * reaches all of them.
+     **/
+    static void trace_frozen(const Object* o, ObjectStack* st)
+    {
+      RegionArena* reg = (RegionArena*)o;
+      assert(reg->frozen);
+
+      for (auto p : *reg)
+        st->push(p);
+
+      for (size_t i = 0; i < reg->frozen_large_count; i++)
+        st->push(reg->frozen_large[i]);
+    }
+
   public:
     inline static RegionArena* get(Object* o)
     {
@@ -331,10 +461,9 @@ namespace verona::rt
     }
 
     /**
-     * Merges `o`'s region into `into`'s region. Both regions must be separate
-     * and be the same kind of region, e.g. two trace regions.
-     *
-     * TODO(region): how to handle merging different types of regions?
+     * Merges `o`'s region into `into`'s region. Both regions must be separate.
+     * `o`'s region may be an arena region or a trace region, whose objects
+     * join the large object ring.
      **/
     static void merge(Alloc* alloc, Object* into, Object* o)
     {
@@ -343,15 +472,24 @@ namespace verona::rt
       RegionBase* other = o->get_region();
       assert(reg != other);
 
+      // An iso in the large object ring is always the last object in it.
+      bool in_arena = true;
+
       if (is_arena_region(other))
+      {
+        in_arena = (o != ((RegionArena*)other)->last_large);
         reg->merge_internal((RegionArena*)other);
+      }
       else
-        assert(0);
+      {
+        // The iso of a trace region is moved to the large object ring.
+        in_arena = false;
+        region::merge_trace(alloc, reg, o);
+      }
 
       // Clear the iso bit on `o`, if it's inside an arena. Otherwise, it's in
       // the large object ring and pointing to some other object.
-      size_t sz = snmalloc::bits::align_up(o->size(), Object::ALIGNMENT);
-      if (sz <= Arena::SIZE)
+      if (in_arena)
         o->init_next(nullptr);
 
       // Merge the ExternalRefTable and RememberedSet.
@@ -377,7 +515,109 @@ namespace verona::rt
       reg->swap_root_internal(prev, next);
     }
 
+    /**
+     * Returns the bytes of memory held by the arenas of the region represented
+     * by the Iso object `o`, including any space not yet used by objects.
+     * Objects in the large object ring are not counted.
+     *
+     * For testing and debugging purposes only.
+     **/
+    static size_t debug_arena_memory(Object* o)
+    {
+      return get(o)->arena_memory();
+    }
+
   private:
+    /**
+     * Start freezing the region with entry point `o` in place. This region
+     * metadata object becomes the root of an SCC with a reference count of
+     * one, for the reference to `o`, and the large object ring is moved into
+     * an array. The caller then adds each object to the SCC.
+     **/
+    void freeze_begin(Alloc* alloc, Object* o)
+    {
+      assert(!frozen);
+
+      // Drop the ISO mark on the entry point. An iso in the large object ring
+      // is always the last object in it.
+      if (o == last_large)
+        o->init_next(this);
+      else
+        o->init_next(nullptr);
+
+      size_t count = 0;
+      for (Object* p = get_next(); p != this; p = p->get_next())
+        count++;
+
+      if (count > 0)
+      {
+        frozen_large = (Object**)alloc->alloc(count * sizeof(Object*));
+
+        size_t i = 0;
+        for (Object* p = get_next(); p != this; p = p->get_next())
+          frozen_large[i++] = p;
+      }
+
+      frozen_large_count = count;
+      frozen = true;
+      last_large = nullptr;
+      make_nonatomic_scc();
+    }
+
+    /**
+     * Finalise, destroy and deallocate every object in a frozen region, and
+     * then the region metadata object. The references out of the region must
+     * already have been released. Returns the number of bytes freed.
+     **/
+    size_t release_frozen(Alloc* alloc)
+    {
+      assert(frozen);
+      size_t total = size();
+
+      // As for release_internal, all finalisers are run before any
+      // destructor.
+      for (auto it = begin<NonTrivial>(); it != end<NonTrivial>(); ++it)
+        (*it)->finalise();
+      for (size_t i = 0; i < frozen_large_count; i++)
+        frozen_large[i]->finalise();
+
+      for (auto it = begin<NonTrivial>(); it != end<NonTrivial>(); ++it)
+        (*it)->destructor();
+
+      for (size_t i = 0; i < frozen_large_count; i++)
+      {
+        Object* p = frozen_large[i];
+        total += p->size();
+        p->destructor();
+        p->dealloc(alloc);
+      }
+
+      if (frozen_large != nullptr)
+        alloc->dealloc(frozen_large, frozen_large_count * sizeof(Object*));
+
+      Arena* arena = first_arena;
+      while (arena != nullptr)
+      {
+        Arena* q = arena->next;
+        total += arena->size();
+        Arena::dealloc(alloc, arena);
+        arena = q;
+      }
+
+      // The ExternalReferenceTable and RememberedSet went when the region was
+      // frozen.
+      Object::dealloc(alloc);
+      return total;
+    }
+
+    size_t arena_memory()
+    {
+      size_t total = 0;
+      for (Arena* a = first_arena; a != nullptr; a = a->next)
+        total += a->size();
+      return total;
+    }
+
     inline void append(Object* hd)
     {
       append(hd, hd);
@@ -401,8 +641,9 @@ namespace verona::rt
      * Allocate an object of type `desc` in the region. Returns a pointer to
      * that object.
      *
-     * If the object is too large to fit in an arena, new memory is allocated
-     * and the object is added to the large object ring.
+     * If the object is too large to fit in the next arena we would allocate,
+     * new memory is allocated and the object is added to the large object
+     * ring.
      *
      * Otherwise, we check if the last arena has space. If so, the object is
      * allocated there. If not, we allocate a new arena.
@@ -415,7 +656,7 @@ namespace verona::rt
     Object* alloc_internal(Alloc* alloc, const Descriptor* desc)
     {
       size_t sz = snmalloc::bits::align_up(desc->size, Object::ALIGNMENT);
-      if (sz > Arena::SIZE)
+      if (sz > Arena::capacity(next_arena_size))
       {
         // Allocate object.
         Object* o = nullptr;
@@ -427,6 +668,7 @@ namespace verona::rt
 
         // Add to large object ring
         append(o);
+        count_object(desc->size, false);
 
         return o;
       }
@@ -435,8 +677,9 @@ namespace verona::rt
       // allocate a new arena.
       if (last_arena == nullptr || last_arena->free_space() < sz)
       {
-        void* p = alloc->alloc<sizeof(Arena)>();
-        Arena* a = new (p) Arena();
+        Arena* a = Arena::create(alloc, next_arena_size);
+        count_arena(next_arena_size);
+        next_arena_size = std::min(2 * next_arena_size, Arena::MAX_SIZE);
 
         if (last_arena == nullptr)
         {
@@ -452,6 +695,7 @@ namespace verona::rt
       }
 
       // Allocate object within that arena.
+      count_object(desc->size, true);
       return last_arena->alloc_obj(desc, sz);
     }
 
@@ -479,6 +723,9 @@ namespace verona::rt
       if (head != other)
         append(head, other->last_large);
 
+      next_arena_size = std::max(next_arena_size, other->next_arena_size);
+      count_merge(other);
+
       assert(last_arena != nullptr ? last_arena->next == nullptr : true);
       assert(
         last_large != nullptr ? last_large->get_next_any_mark() == this : true);
@@ -487,12 +734,13 @@ namespace verona::rt
     void swap_root_internal(Object* oroot, Object* nroot)
     {
       assert(debug_is_in_region(nroot));
-      size_t oroot_size =
-        snmalloc::bits::align_up(oroot->size(), Object::ALIGNMENT);
-      size_t nroot_size =
-        snmalloc::bits::align_up(nroot->size(), Object::ALIGNMENT);
 
-      if (oroot_size <= Arena::SIZE)
+      // Objects in arenas have a null next pointer. An iso in the large
+      // object ring is always the last object in it.
+      bool oroot_in_arena = (oroot != last_large);
+      bool nroot_in_arena = (nroot->get_next_any_mark() == nullptr);
+
+      if (oroot_in_arena)
       {
         // Old root is inside an arena, so we set its next to nullptr.
         oroot->init_next(nullptr);
@@ -501,7 +749,7 @@ namespace verona::rt
       {
         // Old root is in the large object ring.
         assert(oroot == last_large);
-        if (nroot_size <= Arena::SIZE)
+        if (nroot_in_arena)
         {
           // Clear the iso bit on the old root.
           oroot->init_next(this);
@@ -510,7 +758,7 @@ namespace verona::rt
 
       // New root is in the large object ring, need to move it to the last
       // position in the ring. Don't do anything if it's already last.
-      if (nroot != last_large && nroot_size > Arena::SIZE)
+      if (nroot != last_large && !nroot_in_arena)
       {
         Object* x = get_next();
         Object* y = nroot->get_next();
@@ -572,7 +820,7 @@ namespace verona::rt
       while (arena != nullptr)
       {
         Arena* q = arena->next;
-        alloc->dealloc<sizeof(Arena)>(arena);
+        Arena::dealloc(alloc, arena);
         arena = q;
       }
 
@@ -596,6 +844,17 @@ namespace verona::rt
       iterator(RegionArena* r) : reg(r), arena(r->first_arena), ptr(nullptr)
       {
         init_for_arena_or_ring();
+        skip_dead();
+      }
+
+      /**
+       * Iterates over the objects in the arena `a` only. Used by trace
+       * regions, which keep the arenas they adopt but have no RegionArena.
+       **/
+      iterator(Arena* a) : reg(nullptr), arena(a), ptr(nullptr)
+      {
+        init_for_arena_or_ring();
+        skip_dead();
       }
 
       iterator(RegionArena* r, Arena* a, Object* p) : reg(r), arena(a), ptr(p)
@@ -603,6 +862,29 @@ namespace verona::rt
 
     public:
       iterator operator++()
+      {
+        step();
+        skip_dead();
+        return *this;
+      }
+
+      inline bool operator!=(const iterator& other) const
+      {
+        assert(reg == other.reg);
+        return ptr != other.ptr;
+      }
+
+      inline Object* operator*() const
+      {
+        return ptr;
+      }
+
+    private:
+      RegionArena* reg;
+      Arena* arena;
+      Object* ptr;
+
+      void step()
       {
         if (arena != nullptr)
         {
@@ -611,7 +893,7 @@ namespace verona::rt
           if (ptr == nullptr)
           {
             // Go to the next arena or large object ring.
-            arena = arena->next;
+            arena = (reg != nullptr) ? arena->next : nullptr;
             init_for_arena_or_ring();
           }
         }
@@ -620,25 +902,18 @@ namespace verona::rt
           // Currenty iterating through the large object ring.
           ptr = next_in_ring(ptr);
         }
-        return *this;
       }
 
-      inline bool operator!=(const iterator& other) const
-      {
-        assert(reg == other.reg);
-        return ptr != other.ptr;
-      }
-
-      inline Object* operator*() const
+      /**
+       * Step over objects in arenas that have been collected by a trace
+       * region. There are none in the large object ring.
+       **/
+      void skip_dead()
       {
-        return ptr;
+        while ((arena != nullptr) && arena->is_dead(ptr))
+          step();
       }
 
-    private:
-      RegionArena* reg;
-      Arena* arena;
-      Object* ptr;
-
       /**
        * Within the current arena, return a pointer to the next object to be
        * iterated. Return nullptr if we reach the end.
@@ -650,7 +925,7 @@ namespace verona::rt
         std::byte* q = (std::byte*)ptr + sz;
         if constexpr (type == Trivial)
         {
-          assert(q > arena->objects_begin && q <= arena->objects_end);
+          assert(q > arena->objects_begin() && q <= arena->objects_end);
 
           // We have not yet reached the end, so q is valid.
           if (q != arena->objects_end)
@@ -667,7 +942,7 @@ namespace verona::rt
         else if constexpr (type == AllObjects)
         {
           assert(
-            (q > arena->objects_begin && q <= arena->objects_end) ||
+            (q > arena->objects_begin() && q <= arena->objects_end) ||
             (q > arena->non_trivial_begin && q <= arena->non_trivial_end));
 
           // We have not yet reached either end, so q is valid.
@@ -698,8 +973,10 @@ namespace verona::rt
         // Search through the arena list for an object.
         ptr = first_in_arena_list();
 
-        // Didn't find anything in the arenas, so try the large object ring.
-        if (ptr == nullptr)
+        // Didn't find anything in the arenas, so try the large object ring,
+        // unless there is none or the region has been frozen and the ring is
+        // gone.
+        if ((ptr == nullptr) && (reg != nullptr) && !reg->frozen)
           ptr = next_in_ring(reg);
         return;
       }
@@ -718,13 +995,13 @@ namespace verona::rt
         while (arena != nullptr)
         {
           assert(
-            arena->objects_begin < arena->objects_end ||
+            arena->objects_begin() < arena->objects_end ||
             arena->non_trivial_begin < arena->non_trivial_end);
           assert(arena->debug_invariant());
           if constexpr (type == Trivial || type == AllObjects)
           {
-            if (arena->objects_begin != arena->objects_end)
-              return (Object*)arena->objects_begin;
+            if (arena->objects_begin() != arena->objects_end)
+              return (Object*)arena->objects_begin();
           }
           if constexpr (type == NonTrivial || type == AllObjects)
           {
@@ -779,6 +1056,21 @@ namespace verona::rt
     }
 
   private:
+    /**
+     * Iterate over the objects in the arena `a` only, skipping dead ones.
+     **/
+    template<IteratorType type = AllObjects>
+    static iterator<type> arena_begin(Arena* a)
+    {
+      return {a};
+    }
+
+    template<IteratorType type = AllObjects>
+    static iterator<type> arena_end()
+    {
+      return {nullptr, nullptr, nullptr};
+    }
+
     bool debug_is_in_region(Object* o)
     {
       for (auto p : *this)
@@ -789,4 +1081,17 @@ namespace verona::rt
       return false;
     }
   };
+
+  namespace region
+  {
+    inline bool is_arena(Object* o)
+    {
+      return RegionArena::is_arena_region(o);
+    }
+
+    inline size_t release_frozen_arena(Alloc* alloc, Object* o)
+    {
+      return ((RegionArena*)o)->release_frozen(alloc);
+    }
+  } // namespace region
 } // namespace verona::rt
@@ -27,6 +27,50 @@ namespace verona::rt
     Arena,
   };
 
+  /**
+   * How much a region holds. See `RegionBase::get_stats`.
+   **/
+  struct RegionStats
+  {
+    // Objects in the region, including the Iso object, and their total size.
+    size_t objects = 0;
+    size_t live_bytes = 0;
+    // Arenas held by the region, the bytes they take up, and how many of
+    // those bytes are live objects.
+    size_t arenas = 0;
+    size_t arena_bytes = 0;
+    size_t arena_live_bytes = 0;
+    // Bytes of live objects allocated on their own rather than in an arena:
+    // the large objects of an arena region, and the objects of a trace region
+    // that are not in adopted arenas.
+    size_t large_bytes = 0;
+    // Entries in the RememberedSet and the ExternalReferenceTable.
+    size_t remembered_set = 0;
+    size_t external_refs = 0;
+
+    RegionStats& operator+=(const RegionStats& other)
+    {
+      objects += other.objects;
+      live_bytes += other.live_bytes;
+      arenas += other.arenas;
+      arena_bytes += other.arena_bytes;
+      arena_live_bytes += other.arena_live_bytes;
+      large_bytes += other.large_bytes;
+      remembered_set += other.remembered_set;
+      external_refs += other.external_refs;
+      return *this;
+    }
+
+    /**
+     * Bytes of arenas that hold no live object: space not yet allocated,
+     * padding, and objects that have been collected.
+     **/
+    size_t arena_fragmentation() const
+    {
+      return arena_bytes - arena_live_bytes;
+    }
+  };
+
   class RegionBase : public Object,
                      public ExternalReferenceTable,
                      public RememberedSet
@@ -43,12 +87,86 @@ namespace verona::rt
       AllObjects,
     };
 
+    /**
+     * Returns what the region holds, in constant time. The counts are kept up
+     * to date as objects are allocated, merged in and collected. Objects
+     * found to be unreachable by an incremental collection still count until
+     * they have been swept.
+     **/
+    RegionStats get_stats() const
+    {
+      RegionStats s;
+      s.objects = object_count;
+      s.live_bytes = arena_live_bytes + large_bytes;
+      s.arenas = arena_count;
+      s.arena_bytes = arena_bytes;
+      s.arena_live_bytes = arena_live_bytes;
+      s.large_bytes = large_bytes;
+      s.remembered_set = remembered_count();
+      s.external_refs = external_ref_count();
+      return s;
+    }
+
   private:
+    size_t object_count = 0;
+    size_t arena_count = 0;
+    size_t arena_bytes = 0;
+    size_t arena_live_bytes = 0;
+    size_t large_bytes = 0;
+
+    inline void count_object(size_t size, bool in_arena)
+    {
+      object_count++;
+      (in_arena ? arena_live_bytes : large_bytes) += size;
+    }
+
+    inline void uncount_object(size_t size, bool in_arena)
+    {
+      assert(object_count > 0);
+      object_count--;
+      (in_arena ? arena_live_bytes : large_bytes) -= size;
+    }
+
+    inline void count_arena(size_t size)
+    {
+      arena_count++;
+      arena_bytes += size;
+    }
+
+    inline void uncount_arena(size_t size)
+    {
+      assert(arena_count > 0);
+      arena_count--;
+      arena_bytes -= size;
+    }
+
+    /**
+     * Add the counts of `other`, whose objects are moving into this region.
+     **/
+    inline void count_merge(RegionBase* other)
+    {
+      object_count += other->object_count;
+      arena_count += other->arena_count;
+      arena_bytes += other->arena_bytes;
+      arena_live_bytes += other->arena_live_bytes;
+      large_bytes += other->large_bytes;
+    }
+
     inline void dealloc(Alloc* alloc)
+    {
+      dealloc_tables(alloc);
+      Object::dealloc(alloc);
+    }
+
+    /**
+     * Deallocate the ExternalReferenceTable and RememberedSet, but not the
+     * region metadata object itself, which a frozen arena region keeps as
+     * the root of its SCC.
+     **/
+    inline void dealloc_tables(Alloc* alloc)
     {
       ExternalReferenceTable::dealloc(alloc);
       RememberedSet::dealloc(alloc);
-      Object::dealloc(alloc);
     }
   };
 
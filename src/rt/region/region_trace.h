@@ -44,13 +44,41 @@ namespace verona::rt
    * Note that we use the "last" pointer to ensure constant-time merging of two
    * rings. We avoid a "last" pointer for the primary ring, since the iso
    * object is the last object, and we always have a pointer to it.
+   *
+   * When an arena region is merged in, its arenas are adopted whole, rather
+   * than copying each object, and kept in a list of their own. Their objects
+   * are not in either ring, but are marked and swept like any other object.
+   * An arena is freed once none of its objects are left; until then, swept
+   * objects stay in it, marked dead. Objects in adopted arenas cannot become
+   * the root, as the root must be in the primary ring. Freezing the region
+   * moves it into an arena region first, as its objects cannot be freed one
+   * at a time once they are immutable.
+   *
+   * If free lists are enabled, small objects that are swept are kept in
+   * free lists segregated by size class, rather than deallocated, and are
+   * recycled for later allocations in the same region. Each region keeps at
+   * most a capped number of bytes in them, and hands them back to snmalloc
+   * when it is released, merged or frozen, or on request.
+   *
+   * New objects are added at the front of the rings, so the objects
+   * allocated since the last collection are always a prefix of each ring.
+   * In generational mode, these prefixes make up the nursery, and a minor
+   * collection only marks and sweeps the nursery. Everything that survives a
+   * collection is promoted, by moving the start of the mature objects to the
+   * front of the rings. Mature objects are not traced by a minor collection,
+   * so the mutator must call `write_barrier` when it stores a reference into
+   * an object other than the Iso object, and the objects written to are
+   * traced instead.
    **/
   class RegionTrace : public RegionBase
   {
     friend class Freeze;
     friend class Region;
+    friend void region::merge_trace(Alloc* alloc, RegionArena* into, Object* o);
 
   private:
+    using Arena = RegionArena::Arena;
+
     enum RingKind
     {
       TrivialRing,
@@ -62,12 +90,167 @@ namespace verona::rt
     Object* next_not_root;
     Object* last_not_root;
 
+    // Arenas adopted from merged arena regions. May be null.
+    Arena* first_arena = nullptr;
+    Arena* last_arena = nullptr;
+
     // Memory usage in the region.
     size_t current_memory_used = 0;
 
     // Compact representation of previous memory used as a sizeclass.
     snmalloc::sizeclass_t previous_memory_used = 0;
 
+    // Free lists of swept objects, indexed by sizeclass, with the next block
+    // in the first word of each block. Allocated on first use.
+    void** free_lists = nullptr;
+
+    // Bytes held in the free lists.
+    size_t free_list_bytes = 0;
+
+    // The first object in each ring that survived a collection, or this
+    // metadata object if there is none. The objects in front of them make up
+    // the nursery.
+    Object* mature = this;
+    Object* mature_not_root = this;
+
+    // Bytes allocated in the nursery.
+    size_t nursery_memory = 0;
+
+    // Minor collections since the last collection of the whole region.
+    size_t minors_since_major = 0;
+
+    // Objects written to since the last collection, which may refer to the
+    // nursery. Allocated on first use.
+    ObjectStack* written = nullptr;
+    Object* last_written = nullptr;
+    size_t written_count = 0;
+
+  public:
+    /**
+     * Garbage collection statistics for a single region.
+     **/
+    struct GCStats
+    {
+      // Collections run on this region, by `gc` or automatically.
+      size_t collections = 0;
+      // Of those, the ones triggered by the automatic GC policy.
+      size_t auto_collections = 0;
+      // Total bytes reclaimed by all collections.
+      size_t bytes_freed = 0;
+      // Slices of incremental sweeping run after the collection was started.
+      size_t sweep_slices = 0;
+      // The longest pause for automatic collection work, in cycles.
+      uint64_t longest_pause = 0;
+      // Bytes allocated from the region's free lists rather than snmalloc.
+      size_t reused_bytes = 0;
+      // Of the collections, the ones that only collected the nursery.
+      size_t minor_collections = 0;
+    };
+
+  private:
+    GCStats gc_stats;
+
+    static constexpr size_t NO_BUDGET = (std::numeric_limits<size_t>::max)();
+
+    /**
+     * How far a sweep has got. A sweep visits the non-trivial ring, destroys
+     * the non-trivial garbage found there, and then visits the trivial ring.
+     * An incremental collection keeps this between slices.
+     **/
+    struct SweepState
+    {
+      RingKind primary_ring;
+      RingKind ring;
+      // The last object kept in the current ring (or the region metadata
+      // object), and the next object to visit.
+      Object* prev;
+      Object* p;
+      // Finalised non-trivial garbage, waiting to be destroyed.
+      Object* gc;
+      // Number of RememberedSet entries that are still referenced.
+      size_t marked;
+      // Bytes reclaimed so far.
+      size_t freed;
+      // Whether only the nursery is swept, and where the current ring ends.
+      bool nursery;
+      Object* end;
+    };
+
+    // The sweep of an incremental collection, if one is in progress.
+    SweepState* pending_sweep = nullptr;
+
+    /**
+     * When to collect trace regions automatically. A region is collected at
+     * the next safe point once its memory use has grown to `growth_percent`
+     * of what survived its last collection, and to at least `min_bytes`.
+     **/
+    struct GCPolicy
+    {
+      bool enabled = false;
+      size_t growth_percent = 200;
+      size_t min_bytes = 64 * 1024;
+      // If non-zero, automatic collections sweep at most this many objects
+      // at each safe point.
+      size_t slice_objects = 0;
+    };
+
+    static GCPolicy& policy()
+    {
+      static GCPolicy policy;
+      return policy;
+    }
+
+    /**
+     * Objects up to this size are kept in free lists when they are swept.
+     **/
+    static constexpr size_t FREE_LIST_MAX_SIZE = 1024;
+
+    /**
+     * Whether swept objects are kept in region-local free lists, and how
+     * many bytes a single region may keep in them.
+     **/
+    struct FreeListPolicy
+    {
+      bool enabled = false;
+      size_t max_bytes = 256 * 1024;
+    };
+
+    static FreeListPolicy& free_list_policy()
+    {
+      static FreeListPolicy policy;
+      return policy;
+    }
+
+    /**
+     * Whether collections of trace regions only collect the nursery, and how
+     * often the whole region is collected instead. A region is collected
+     * whole after `minors_per_major` minor collections, once more than
+     * `max_written` objects have been written to since its last collection,
+     * and while it has adopted arenas.
+     **/
+    struct GenerationalPolicy
+    {
+      bool enabled = false;
+      size_t nursery_bytes = 64 * 1024;
+      size_t minors_per_major = 8;
+      size_t max_written = 4096;
+    };
+
+    static GenerationalPolicy& generational_policy()
+    {
+      static GenerationalPolicy policy;
+      return policy;
+    }
+
+    /**
+     * Number of regions with an incremental collection in progress.
+     **/
+    static std::atomic<size_t>& pending_sweeps()
+    {
+      static std::atomic<size_t> pending = 0;
+      return pending;
+    }
+
     explicit RegionTrace(Object* o) : next_not_root(this), last_not_root(this)
     {
       set_descriptor(desc());
@@ -83,6 +266,236 @@ namespace verona::rt
     }
 
   public:
+    /**
+     * Enable or disable automatic collection of trace regions, and set when a
+     * region has grown enough to be collected. See `GCPolicy`.
+     **/
+    static void set_auto_gc(
+      bool enabled, size_t growth_percent = 200, size_t min_bytes = 64 * 1024)
+    {
+      assert(growth_percent >= 100);
+      auto& p = policy();
+      p.enabled = enabled;
+      p.growth_percent = growth_percent;
+      p.min_bytes = min_bytes;
+    }
+
+    static bool get_auto_gc()
+    {
+      return policy().enabled;
+    }
+
+    /**
+     * Spread the sweep of automatic collections over several safe points,
+     * sweeping at most `slice_objects` objects at each, or sweep in one go if
+     * `slice_objects` is zero.
+     *
+     * Marking is still done in one pause: objects are updated with plain
+     * stores, so there is no write barrier that could keep an interrupted
+     * mark sound. Sweeping only touches garbage and the ring links, so it can
+     * be interrupted as long as new objects are never swept and new
+     * RememberedSet entries are marked, which `alloc` and `insert` ensure.
+     **/
+    static void set_incremental_gc(size_t slice_objects)
+    {
+      Systematic::cout() << "Set incremental GC slice: " << slice_objects
+                         << std::endl;
+      policy().slice_objects = slice_objects;
+    }
+
+    static size_t get_incremental_gc()
+    {
+      return policy().slice_objects;
+    }
+
+    /**
+     * Enable or disable region-local free lists, and set how many bytes a
+     * single region may keep in them. Objects swept once a region's free
+     * lists are full are deallocated as usual.
+     *
+     * A block is only recycled for an object of the same sizeclass, so it can
+     * still be deallocated with the size of the object that reuses it.
+     *
+     * Regions held directly by a cown hand their free lists back to snmalloc
+     * when the cown runs out of messages.
+     **/
+    static void set_free_lists(bool enabled, size_t max_bytes = 256 * 1024)
+    {
+      Systematic::cout() << "Set region free lists: " << enabled << " "
+                         << max_bytes << std::endl;
+      auto& p = free_list_policy();
+      p.enabled = enabled;
+      p.max_bytes = max_bytes;
+    }
+
+    static bool get_free_lists()
+    {
+      return free_list_policy().enabled;
+    }
+
+    /**
+     * Enable or disable generational collection of trace regions. See
+     * `GenerationalPolicy`. If automatic collection is enabled, a region is
+     * also collected once `nursery_bytes` have been allocated in its nursery.
+     *
+     * WARNING: only enable this if every store into a trace region goes
+     * through `write_barrier`. The runtime inserts no barrier of its own.
+     * C++ code that stores into `V<>` objects must call `write_barrier` after
+     * every store of a reference into an object other than the Iso object.
+     * Otherwise a minor collection frees nursery objects that are only
+     * reachable from a mature object, leaving that object with a dangling
+     * pointer. The interpreter's stores already call it.
+     **/
+    static void set_generational(
+      bool enabled,
+      size_t nursery_bytes = 64 * 1024,
+      size_t minors_per_major = 8,
+      size_t max_written = 4096)
+    {
+      Systematic::cout() << "Set generational GC: " << enabled << " "
+                         << nursery_bytes << " " << minors_per_major
+                         << std::endl;
+      auto& p = generational_policy();
+      p.enabled = enabled;
+      p.nursery_bytes = nursery_bytes;
+      p.minors_per_major = minors_per_major;
+      p.max_written = max_written;
+    }
+
+    static bool get_generational()
+    {
+      return generational_policy().enabled;
+    }
+
+    /**
+     * Record that a reference has been stored into the object `p`, in the
+     * region represented by the Iso object `in`. Only needed in generational
+     * mode, where the next minor collection traces the objects written to.
+     * If too many objects are written to, the next collection is a major one
+     * instead.
+     **/
+    static void write_barrier(Alloc* alloc, Object* in, Object* p)
+    {
+      if (!get_generational() || (p == in))
+        return;
+
+      RegionTrace* reg = get(in);
+      if (
+        (p == reg->last_written) ||
+        (reg->written_count > generational_policy().max_written))
+        return;
+
+      if (reg->written == nullptr)
+      {
+        void* s = alloc->alloc<sizeof(ObjectStack)>();
+        reg->written = new (s) ObjectStack(alloc);
+      }
+
+      reg->written->push(p);
+      reg->last_written = p;
+      reg->written_count++;
+    }
+
+    /**
+     * Hand the objects kept in the free lists of the region represented by
+     * the Iso object `o` back to snmalloc. Returns the number of bytes
+     * handed back.
+     **/
+    static size_t trim_free_lists(Alloc* alloc, Object* o)
+    {
+      RegionTrace* reg = get(o);
+      size_t bytes = reg->free_list_bytes;
+      reg->release_free_lists(alloc);
+      return bytes;
+    }
+
+    /**
+     * Returns the number of bytes kept in the free lists of the region
+     * represented by the Iso object `o`.
+     **/
+    static size_t debug_free_list_memory(Object* o)
+    {
+      return get(o)->free_list_bytes;
+    }
+
+    /**
+     * Returns true if some region has an incremental collection in progress,
+     * which should be carried on at the next safe point.
+     **/
+    static bool sweeps_pending()
+    {
+      return pending_sweeps() > 0;
+    }
+
+    /**
+     * Collect the region represented by the Iso object `o` if it has grown
+     * enough since its last collection, or sweep the next slice of its
+     * incremental collection. Must only be called at a safe point, where
+     * nothing outside the region's object graph refers into it. Returns the
+     * length of the pause in cycles, or zero if there was nothing to do.
+     **/
+    static uint64_t gc_if_grown(Alloc* alloc, Object* o)
+    {
+      RegionTrace* reg = get(o);
+
+      if (
+        (reg->pending_sweep == nullptr) &&
+        !(policy().enabled && reg->should_gc()))
+        return 0;
+
+      uint64_t start = Aal::tick();
+      size_t slice = policy().slice_objects;
+      ObjectStack f(alloc);
+      ObjectStack collect(alloc);
+
+      if (reg->pending_sweep != nullptr)
+      {
+        reg->gc_stats.sweep_slices++;
+        reg->sweep_step(alloc, o, f, collect, slice == 0 ? NO_BUDGET : slice);
+      }
+      else
+      {
+        Systematic::cout() << "Region auto GC: " << o << " using "
+                           << reg->current_memory_used << " bytes"
+                           << std::endl;
+        reg->gc_stats.auto_collections++;
+        reg->collect_garbage(alloc, o, f, collect, slice != 0);
+      }
+
+      reg->release_collected(alloc, f, collect);
+
+      uint64_t pause = Aal::tick() - start;
+      reg->gc_stats.longest_pause =
+        std::max(reg->gc_stats.longest_pause, pause);
+      return pause;
+    }
+
+    /**
+     * Complete the incremental collection of the region represented by the
+     * Iso object `o`, if one is in progress.
+     **/
+    static void finish_gc(Alloc* alloc, Object* o)
+    {
+      RegionTrace* reg = get(o);
+
+      if (reg->pending_sweep == nullptr)
+        return;
+
+      ObjectStack f(alloc);
+      ObjectStack collect(alloc);
+      reg->finish_sweep(alloc, o, f, collect);
+      reg->release_collected(alloc, f, collect);
+    }
+
+    /**
+     * Returns the garbage collection statistics for the region represented by
+     * the Iso object `o`.
+     **/
+    static const GCStats& get_gc_stats(Object* o)
+    {
+      return get(o)->gc_stats;
+    }
+
     inline static RegionTrace* get(Object* o)
     {
       assert(o->debug_is_iso());
@@ -116,7 +529,9 @@ namespace verona::rt
 
       void* p = alloc->alloc<sizeof(RegionTrace)>();
       RegionTrace* reg = new (p) RegionTrace(o);
+      reg->nursery_memory += desc->size;
       reg->use_memory(desc->size);
+      reg->count_object(desc->size, false);
 
       o->set_descriptor(desc);
       o->init_iso();
@@ -139,8 +554,10 @@ namespace verona::rt
     {
       RegionTrace* reg = get(in);
 
-      Object* o = nullptr;
-      if constexpr (size == 0)
+      Object* o = (Object*)reg->reuse(desc->size);
+      if (o != nullptr)
+        reg->gc_stats.reused_bytes += desc->size;
+      else if constexpr (size == 0)
         o = (Object*)alloc->alloc(desc->size);
       else
         o = (Object*)alloc->alloc<size>();
@@ -151,7 +568,9 @@ namespace verona::rt
       reg->append(o);
 
       // GC heuristics.
+      reg->nursery_memory += desc->size;
       reg->use_memory(desc->size);
+      reg->count_object(desc->size, false);
 
       return o;
     }
@@ -170,14 +589,25 @@ namespace verona::rt
 
       Object::RegionMD c;
       o = o->root_and_class(c);
-      reg->RememberedSet::insert<transfer>(alloc, o);
+
+      if (reg->pending_sweep == nullptr)
+      {
+        reg->RememberedSet::insert<transfer>(alloc, o);
+        return;
+      }
+
+      // The region is being swept incrementally, so the entry must be marked,
+      // or the end of the sweep would drop it. Marking takes a reference
+      // count for a new entry, so drop a transferred one.
+      reg->RememberedSet::mark(alloc, o, reg->pending_sweep->marked);
+      if constexpr (transfer == YesTransfer)
+        o->decref();
     }
 
     /**
-     * Merges `o`'s region into `into`'s region. Both regions must be separate
-     * and be the same kind of region, e.g. two trace regions.
-     *
-     * TODO(region): how to handle merging different types of regions?
+     * Merges `o`'s region into `into`'s region. Both regions must be separate.
+     * `o`'s region may be a trace region, or an arena region, whose arenas
+     * are adopted without copying the objects in them.
      **/
     static void merge(Alloc* alloc, Object* into, Object* o)
     {
@@ -186,10 +616,26 @@ namespace verona::rt
       RegionBase* other = o->get_region();
       assert(reg != other);
 
+      // Rings are only merged between collections.
+      finish_gc(alloc, into);
+
       if (is_trace_region(other))
+      {
+        finish_gc(alloc, o);
         reg->merge_internal(o, (RegionTrace*)other);
+        ((RegionTrace*)other)->release_side_tables(alloc);
+      }
       else
-        assert(0);
+      {
+        assert(RegionArena::is_arena_region(other));
+        reg->adopt_arenas(o, (RegionArena*)other);
+      }
+
+      // Whatever now refers to `o` was stored into without a write barrier,
+      // so treat every object as being in the nursery until the next
+      // collection, which then traces the merged objects from the root.
+      reg->mature = reg;
+      reg->mature_not_root = reg;
 
       // Merge the ExternalReferenceTable and RememberedSet.
       reg->ExternalReferenceTable::merge(alloc, other);
@@ -201,15 +647,30 @@ namespace verona::rt
 
     /**
      * Swap the Iso (root) Object of a region, `prev`, with another Object
-     * within that region, `next`.
+     * within that region, `next`. `next` must not be in an adopted arena, as
+     * the root has to be in a ring. The process aborts if it is.
      **/
     static void swap_root(Object* prev, Object* next)
     {
       assert(prev != next);
       assert(prev->debug_is_iso());
+
+      // Sweeping relies on the root being the end of the primary ring.
+      finish_gc(ThreadAlloc::get(), prev);
+
       assert(next->debug_is_mutable());
       assert(prev->get_region() != next);
 
+      // Objects in rings are never followed by null, unlike those in arenas.
+      // Relinking an arena object would corrupt the rings, so this is checked
+      // in release builds too.
+      if (next->get_next() == nullptr)
+      {
+        Systematic::cout() << "Region swap root into an arena: " << next
+                           << std::endl;
+        abort();
+      }
+
       RegionTrace* reg = get(prev);
       reg->swap_root_internal(prev, next);
     }
@@ -228,16 +689,97 @@ namespace verona::rt
       RegionTrace* reg = get(o);
       ObjectStack f(alloc);
       ObjectStack collect(alloc);
+
+      reg->collect_garbage(alloc, o, f, collect, false);
+      reg->release_collected(alloc, f, collect);
+    }
+
+  private:
+    /**
+     * Mark the region represented by the Iso object `o`, and then sweep it
+     * now, or leave the sweep to be done incrementally. Any incremental
+     * collection already in progress is completed first.
+     **/
+    void collect_garbage(
+      Alloc* alloc,
+      Object* o,
+      ObjectStack& f,
+      ObjectStack& collect,
+      bool incremental)
+    {
+      finish_sweep(alloc, o, f, collect);
+      gc_stats.collections++;
+
+      if (minor_due())
+      {
+        collect_nursery(alloc, o, f, collect);
+        return;
+      }
+
+      minors_since_major = 0;
       size_t marked = 0;
+      mark(alloc, o, f, marked);
+
+      if (!incremental)
+      {
+        gc_stats.bytes_freed += sweep(alloc, o, f, collect, marked);
+        return;
+      }
+
+      // Garbage can wait a while to be swept, so stop external references
+      // from resolving to it now.
+      ExternalReferenceTable::erase_unmarked(alloc);
+
+      Systematic::cout() << "Region GC: sweeping incrementally: " << o
+                         << std::endl;
+      void* p = alloc->alloc<sizeof(SweepState)>();
+      pending_sweep = new (p) SweepState(start_sweep(o, marked));
+      pending_sweeps()++;
+    }
+
+    /**
+     * Sweep at most `budget` more objects of the incremental collection in
+     * progress. Returns true if the collection is complete.
+     **/
+    bool sweep_step(
+      Alloc* alloc,
+      Object* o,
+      ObjectStack& f,
+      ObjectStack& collect,
+      size_t budget)
+    {
+      SweepState* s = pending_sweep;
+      assert(s != nullptr);
+
+      if (!sweep_slice<SweepAll::No>(alloc, o, *s, f, collect, budget))
+        return false;
+
+      Systematic::cout() << "Region GC: incremental sweep complete: " << o
+                         << std::endl;
+      gc_stats.bytes_freed += s->freed;
+      alloc->dealloc<sizeof(SweepState)>(s);
+      pending_sweep = nullptr;
+      pending_sweeps()--;
+      return true;
+    }
 
-      reg->mark(alloc, o, f, marked);
-      reg->sweep(alloc, o, f, collect, marked);
+    void finish_sweep(
+      Alloc* alloc, Object* o, ObjectStack& f, ObjectStack& collect)
+    {
+      if (pending_sweep != nullptr)
+        sweep_step(alloc, o, f, collect, NO_BUDGET);
+    }
 
+    /**
+     * Release the unreachable subregions a sweep found.
+     **/
+    void release_collected(Alloc* alloc, ObjectStack& f, ObjectStack& collect)
+    {
       // `collect` contains all the iso objects to unreachable subregions.
       // Since they are unreachable, we can just release them.
       while (!collect.empty())
       {
-        o = collect.pop();
+        Object* o = collect.pop();
         assert(o->debug_is_iso());
         Systematic::cout() << "Region GC: releasing unreachable subregion: "
                            << o << std::endl;
@@ -245,20 +787,28 @@ namespace verona::rt
         // Note that we need to dispatch because `r` is a different region
         // metadata object.
         RegionBase* r = o->get_region();
-        assert(r != reg);
+        assert(r != this);
 
         // Unfortunately, we can't use Region::release_internal because of a
-        // circular dependency between header files.
+        // circular dependency between header files. Large subregions may be
+        // left to idle threads.
         if (RegionTrace::is_trace_region(r))
-          ((RegionTrace*)r)->release_internal(alloc, o, f, collect);
+        {
+          auto t = (RegionTrace*)r;
+          if (!DeferredRelease::defer_region(alloc, o, t->current_memory_used))
+            t->release_internal(alloc, o, f, collect);
+        }
         else if (RegionArena::is_arena_region(r))
-          ((RegionArena*)r)->release_internal(alloc, o, f, collect);
+        {
+          auto a = (RegionArena*)r;
+          if (!DeferredRelease::defer_region(alloc, o, a->arena_memory()))
+            a->release_internal(alloc, o, f, collect);
+        }
         else
           abort();
       }
     }
 
-  private:
     inline void append(Object* hd)
     {
       append(hd, hd);
@@ -303,12 +853,122 @@ namespace verona::rt
       if (head != other)
         append(head, other->last_not_root);
 
+      append_arenas(other->first_arena, other->last_arena);
+      count_merge(other);
+
       // Update memory usage.
       current_memory_used += other->current_memory_used;
+      nursery_memory += other->current_memory_used;
 
       previous_memory_used = size_to_sizeclass(
-        sizeclass_to_size(other->previous_memory_used) +
+        sizeclass_to_size(previous_memory_used) +
         sizeclass_to_size(other->previous_memory_used));
+
+      gc_stats.collections += other->gc_stats.collections;
+      gc_stats.auto_collections += other->gc_stats.auto_collections;
+      gc_stats.bytes_freed += other->gc_stats.bytes_freed;
+      gc_stats.sweep_slices += other->gc_stats.sweep_slices;
+      gc_stats.longest_pause =
+        std::max(gc_stats.longest_pause, other->gc_stats.longest_pause);
+      gc_stats.reused_bytes += other->gc_stats.reused_bytes;
+      gc_stats.minor_collections += other->gc_stats.minor_collections;
+    }
+
+    /**
+     * Adopt the objects of the arena region `other`, whose Iso object is `o`.
+     * Objects in the large object ring were each allocated separately, so
+     * they join the rings. The arenas are kept whole.
+     **/
+    void adopt_arenas(Object* o, RegionArena* other)
+    {
+      // An iso in the large object ring is always the last object in it, and
+      // is added to the rings below.
+      if (o != other->last_large)
+        o->init_next(nullptr);
+
+      Object* p = other->get_next();
+      while (p != other)
+      {
+        Object* q = p->get_next_any_mark();
+        append(p);
+        use_memory(p->size());
+        p = q;
+      }
+
+      append_arenas(other->first_arena, other->last_arena);
+      use_memory(other->arena_memory());
+      count_merge(other);
+    }
+
+    void append_arenas(Arena* first, Arena* last)
+    {
+      if (first == nullptr)
+        return;
+
+      if (last_arena == nullptr)
+        first_arena = first;
+      else
+        last_arena->next = first;
+
+      last_arena = last;
+      assert(last_arena->next == nullptr);
+    }
+
+    /**
+     * Move every object in this region, whose Iso object is `o`, into the
+     * arena region `into`. The objects in the rings join its large object
+     * ring, with `o` last, and the adopted arenas join its arenas. The
+     * caller deals with the iso bit of `o`, and with this metadata object.
+     **/
+    void move_to_arena(RegionArena* into, Object* o)
+    {
+      assert(pending_sweep == nullptr);
+
+      // Primary ring first: if the large object ring is empty, `o` becomes
+      // its last object.
+      into->append(get_next(), o);
+
+      if (next_not_root != this)
+        into->append(next_not_root, last_not_root);
+
+      // Put the adopted arenas in front, so that `into` carries on
+      // allocating in its last arena.
+      if (first_arena != nullptr)
+      {
+        last_arena->next = into->first_arena;
+        into->first_arena = first_arena;
+        if (into->last_arena == nullptr)
+          into->last_arena = last_arena;
+      }
+
+      into->count_merge(this);
+
+      assert(into->last_large->get_next_any_mark() == into);
+    }
+
+    /**
+     * Turn the region represented by the Iso object `o`, which must have
+     * adopted arenas, into an arena region with the same objects.
+     **/
+    static void convert_to_arena(Alloc* alloc, Object* o)
+    {
+      RegionTrace* reg = get(o);
+      assert(reg->first_arena != nullptr);
+      finish_gc(alloc, o);
+
+      Systematic::cout() << "Region convert to arena: " << o << std::endl;
+
+      void* p = alloc->alloc<sizeof(RegionArena)>();
+      RegionArena* into = new (p) RegionArena();
+      reg->move_to_arena(into, o);
+
+      // `o` is the last object in the large object ring, as it must be.
+      o->init_iso();
+      o->set_region(into);
+
+      into->ExternalReferenceTable::merge(alloc, reg);
+      into->RememberedSet::merge(alloc, reg);
+      reg->dealloc(alloc);
     }
 
     void swap_root_internal(Object* oroot, Object* nroot)
@@ -348,6 +1008,11 @@ namespace verona::rt
 
       nroot->init_iso();
       nroot->set_region(this);
+
+      // The rings have been reordered, so treat every object as being in
+      // the nursery until the next collection.
+      mature = this;
+      mature_not_root = this;
     }
 
     /**
@@ -387,6 +1052,95 @@ namespace verona::rt
       }
     }
 
+    /**
+     * Whether the next collection should only collect the nursery.
+     **/
+    bool minor_due()
+    {
+      auto& p = generational_policy();
+      return p.enabled && (first_arena == nullptr) &&
+        (written_count <= p.max_written) &&
+        (minors_since_major < p.minors_per_major);
+    }
+
+    /**
+     * Collect the nursery of the region represented by the Iso object `o`.
+     * The nursery is marked pending first, so that marking can tell it apart
+     * from mature objects, which are neither traced nor swept. The
+     * RememberedSet is left alone, as the references from mature objects to
+     * its entries are not found.
+     **/
+    void collect_nursery(
+      Alloc* alloc, Object* o, ObjectStack& f, ObjectStack& collect)
+    {
+      Systematic::cout() << "Region GC: minor collection: " << o << std::endl;
+      gc_stats.minor_collections++;
+      minors_since_major++;
+
+      pend_nursery(get_next(), mature);
+      pend_nursery(next_not_root, mature_not_root);
+
+      o->trace(f);
+
+      if (written != nullptr)
+      {
+        // Mature objects that were written to may refer to the nursery.
+        // Those in the nursery are traced if they are reachable.
+        while (!written->empty())
+        {
+          Object* p = written->pop();
+          if (p->get_class() == Object::UNMARKED)
+            p->trace(f);
+        }
+      }
+
+      while (!f.empty())
+      {
+        Object* p = f.pop();
+        if (p->get_class() == Object::PENDING)
+        {
+          p->unmark_pending();
+          p->mark();
+          p->trace(f);
+        }
+      }
+
+      SweepState s = start_sweep(o, 0, true);
+      sweep_slice<SweepAll::No>(alloc, o, s, f, collect, NO_BUDGET);
+      gc_stats.bytes_freed += s.freed;
+    }
+
+    /**
+     * Mark the objects from `p` up to `end` pending.
+     **/
+    void pend_nursery(Object* p, Object* end)
+    {
+      for (; p != end; p = p->get_next_any_mark())
+      {
+        if (p->get_class() == Object::UNMARKED)
+          p->mark_pending();
+      }
+    }
+
+    /**
+     * Promote everything in the rings after a collection, and forget the
+     * objects written to.
+     **/
+    void promote()
+    {
+      mature = get_next();
+      mature_not_root = next_not_root;
+      nursery_memory = 0;
+
+      if (written != nullptr)
+      {
+        while (!written->empty())
+          written->pop();
+      }
+      last_written = nullptr;
+      written_count = 0;
+    }
+
     enum class SweepAll
     {
       Yes,
@@ -396,38 +1150,112 @@ namespace verona::rt
     /**
      * Sweep and deallocate all unmarked objects in the region. If we find an
      * unmarked object that points to a subregion, we add it to `collect` so we
-     * can release it later.
+     * can release it later. Returns the number of bytes reclaimed.
      *
      * If sweep_all is Yes, it is assumed the entire region is being released
      * and the Iso object is collected as well.
      **/
     template<SweepAll sweep_all = SweepAll::No>
-    void sweep(
+    size_t sweep(
       Alloc* alloc,
       Object* o,
       ObjectStack& f,
       ObjectStack& collect,
       size_t marked)
     {
-      current_memory_used = 0;
+      SweepState s = start_sweep(o, marked);
+      sweep_slice<sweep_all>(alloc, o, s, f, collect, NO_BUDGET);
+      return s.freed;
+    }
+
+    SweepState start_sweep(Object* o, size_t marked, bool nursery = false)
+    {
+      // A minor collection leaves the memory used by mature objects alone,
+      // and takes off what it frees at the end.
+      if (!nursery)
+        current_memory_used = 0;
 
       RingKind primary_ring = o->is_trivial() ? TrivialRing : NonTrivialRing;
 
       // We sweep the non-trivial ring first, as finalisers in there could refer
-      // to other objects. The ISO object o could be deallocated by either of
-      // these two lines.
-      sweep_ring<NonTrivialRing, sweep_all>(alloc, o, primary_ring, f, collect);
-      sweep_ring<TrivialRing, sweep_all>(alloc, o, primary_ring, f, collect);
+      // to other objects.
+      SweepState s = {
+        primary_ring, NonTrivialRing, this, nullptr, nullptr, marked, 0,
+        nursery, nullptr};
+      s.p = ring_head(s);
+      s.end = ring_end(s);
+      return s;
+    }
+
+    /**
+     * Sweep at most `budget` objects, carrying on from `s`. Returns true if
+     * the sweep is complete. The ISO object o could be deallocated by either
+     * ring if sweep_all is Yes.
+     **/
+    template<SweepAll sweep_all>
+    bool sweep_slice(
+      Alloc* alloc,
+      Object* o,
+      SweepState& s,
+      ObjectStack& f,
+      ObjectStack& collect,
+      size_t budget)
+    {
+      if (s.ring == NonTrivialRing)
+      {
+        if (!sweep_ring<NonTrivialRing, sweep_all>(alloc, s, budget))
+          return false;
+
+        // Adopted arenas are swept in one go, once all of the non-trivial
+        // garbage in the rings has been finalised.
+        if (!s.nursery)
+          sweep_arenas<sweep_all>(o, s, f, collect);
+        destroy_garbage<sweep_all>(alloc, o, s.gc, f, collect);
+        if (!s.nursery)
+          destroy_arena_garbage(alloc);
+        s.ring = TrivialRing;
+        s.prev = this;
+        s.p = ring_head(s);
+        s.end = ring_end(s);
+        s.gc = nullptr;
+      }
+
+      if (!sweep_ring<TrivialRing, sweep_all>(alloc, s, budget))
+        return false;
+
+      if (s.nursery)
+      {
+        current_memory_used -= s.freed;
+      }
+      else
+      {
+        hash_set->sweep_set(alloc, s.marked);
+        previous_memory_used = size_to_sizeclass(current_memory_used);
+      }
+
+      promote();
+      return true;
+    }
+
+    Object* ring_head(SweepState& s)
+    {
+      return s.ring == s.primary_ring ? get_next() : next_not_root;
+    }
 
-      hash_set->sweep_set(alloc, marked);
-      previous_memory_used = size_to_sizeclass(current_memory_used);
+    Object* ring_end(SweepState& s)
+    {
+      if (!s.nursery)
+        return this;
+
+      return s.ring == s.primary_ring ? mature : mature_not_root;
     }
 
     /**
      * Garbage Collect an object. If the object is trivial, then it is
-     * deallocated immediately. Otherwise it is added to the `gc` linked list.
+     * deallocated or recycled immediately. Otherwise it is added to the `gc`
+     * linked list.
      */
-    template<RingKind ring>
+    template<RingKind ring, SweepAll sweep_all>
     void sweep_object(Alloc* alloc, Object* p, Object** gc)
     {
       assert(
@@ -442,7 +1270,7 @@ namespace verona::rt
         if (p->has_ext_ref())
           ExternalReferenceTable::erase(p);
 
-        p->dealloc(alloc);
+        recycle<sweep_all>(alloc, p);
       }
       else
       {
@@ -460,21 +1288,34 @@ namespace verona::rt
     }
 
     template<RingKind ring, SweepAll sweep_all>
-    void sweep_ring(
-      Alloc* alloc,
-      Object* o,
-      RingKind primary_ring,
-      ObjectStack& f,
-      ObjectStack& collect)
+    bool sweep_ring(Alloc* alloc, SweepState& s, size_t& budget)
     {
-      Object* prev = this;
-      Object* p = ring == primary_ring ? get_next() : next_not_root;
-      Object* gc = nullptr;
+      assert(s.ring == ring);
+
+      // Objects allocated since the last slice were added at the head of the
+      // ring, in front of the ones still to be swept. They were not there
+      // when the region was marked, so step over them.
+      if ((s.prev == this) && (s.p != this))
+      {
+        for (Object* q = ring_head(s); q != s.p; q = q->get_next())
+          s.prev = q;
+      }
+
+      Object* prev = s.prev;
+      Object* p = s.p;
 
       // Note: we don't use the iterator because we need to remove and
       // deallocate objects from the rings.
-      while (p != this)
+      while (p != s.end)
       {
+        if (budget == 0)
+        {
+          s.prev = prev;
+          s.p = p;
+          return false;
+        }
+        budget--;
+
         switch (p->get_class())
         {
           case Object::ISO:
@@ -487,9 +1328,9 @@ namespace verona::rt
             // entire region anyway.
             if constexpr (sweep_all == SweepAll::Yes)
             {
-              sweep_object<ring>(alloc, p, &gc);
+              sweep_object<ring, sweep_all>(alloc, p, &s.gc);
             }
-            else
+            else if (!s.nursery)
             {
               use_memory(p->size());
             }
@@ -501,24 +1342,33 @@ namespace verona::rt
           case Object::MARKED:
           {
             assert(sweep_all == SweepAll::No);
-            use_memory(p->size());
+            if (!s.nursery)
+              use_memory(p->size());
             p->unmark();
             prev = p;
             p = p->get_next();
             break;
           }
 
+          case Object::PENDING:
+            // Garbage found by a minor collection.
+            assert(s.nursery);
+            p->unmark_pending();
+            [[fallthrough]];
+
           case Object::UNMARKED:
           {
             Object* q = p->get_next();
-            sweep_object<ring>(alloc, p, &gc);
+            s.freed += p->size();
+            uncount_object(p->size(), false);
+            sweep_object<ring, sweep_all>(alloc, p, &s.gc);
 
-            if (ring != primary_ring && prev == this)
+            if (ring != s.primary_ring && prev == this)
               next_not_root = q;
             else
               prev->set_next(q);
 
-            if (ring != primary_ring && last_not_root == p)
+            if (ring != s.primary_ring && last_not_root == p)
               last_not_root = prev;
 
             p = q;
@@ -530,33 +1380,150 @@ namespace verona::rt
         }
       }
 
+      return true;
+    }
+
+    /**
+     * Destroy the finalised non-trivial garbage in the `gc` list, after
+     * finding the subregions it refers to.
+     **/
+    template<SweepAll sweep_all>
+    void destroy_garbage(
+      Alloc* alloc,
+      Object* o,
+      Object* gc,
+      ObjectStack& f,
+      ObjectStack& collect)
+    {
       // We need to collect all sub-regions and then deallocate the objects.
       // Unfortunately we can't do this as a single pass, as find_iso_fields
       // looks at the referenced object's header to see if it points to the same
       // region or to a different one.
-      if constexpr (ring == NonTrivialRing)
+      Object* p = gc;
+      while (p != nullptr)
       {
-        p = gc;
-        while (p != nullptr)
+        p->find_iso_fields(o, f, collect);
+        p = p->get_next();
+      }
+
+      p = gc;
+      while (p != nullptr)
+      {
+        Object* q = p->get_next();
+        p->destructor();
+        recycle<sweep_all>(alloc, p);
+        p = q;
+      }
+    }
+
+    /**
+     * Sweep the objects in adopted arenas. Reachable objects are unmarked,
+     * and unreachable trivial objects are marked dead straight away.
+     * Unreachable non-trivial objects are finalised, and linked into a list,
+     * ended by this metadata object, until `destroy_arena_garbage` destroys
+     * them. The subregions they refer to are added to `collect`.
+     **/
+    template<SweepAll sweep_all>
+    void sweep_arenas(
+      Object* o, SweepState& s, ObjectStack& f, ObjectStack& collect)
+    {
+      Object* gc = this;
+
+      for (Arena* a = first_arena; a != nullptr; a = a->next)
+      {
+        for (auto it = RegionArena::arena_begin(a);
+             it != RegionArena::arena_end();
+             ++it)
         {
-          p->find_iso_fields(o, f, collect);
-          p = p->get_next();
+          Object* p = *it;
+
+          if (p->get_class() == Object::MARKED)
+          {
+            assert(sweep_all == SweepAll::No);
+            p->unmark();
+            continue;
+          }
+
+          s.freed += p->size();
+          uncount_object(p->size(), true);
+
+          if (p->has_ext_ref())
+            ExternalReferenceTable::erase(p);
+
+          if (p->is_trivial())
+          {
+            a->set_dead(p);
+          }
+          else
+          {
+            p->finalise();
+            p->init_next(gc);
+            gc = p;
+          }
         }
+      }
 
-        p = gc;
-        while (p != nullptr)
+      // As for destroy_garbage, this is only safe once every finaliser has
+      // run.
+      for (Object* p = gc; p != this; p = p->get_next())
+        p->find_iso_fields(o, f, collect);
+    }
+
+    /**
+     * Destroy the non-trivial garbage found by `sweep_arenas`, and free the
+     * adopted arenas that have no objects left in them. This is done after
+     * the garbage in the rings has been destroyed, as finding the subregions
+     * of that garbage may look at objects in the arenas freed here.
+     **/
+    void destroy_arena_garbage(Alloc* alloc)
+    {
+      Arena* prev = nullptr;
+      Arena* a = first_arena;
+
+      while (a != nullptr)
+      {
+        bool live = false;
+
+        for (auto it = RegionArena::arena_begin(a);
+             it != RegionArena::arena_end();
+             ++it)
         {
-          Object* q = p->get_next();
+          Object* p = *it;
+
+          // Live objects in an arena are followed by null, and garbage by the
+          // rest of the `gc` list.
+          if (p->get_next() == nullptr)
+          {
+            live = true;
+            continue;
+          }
+
           p->destructor();
-          p->dealloc(alloc);
-          p = q;
+          a->set_dead(p);
         }
-      }
-      else
-      {
-        UNUSED(o);
-        UNUSED(f);
-        UNUSED(collect);
+
+        Arena* q = a->next;
+
+        if (live)
+        {
+          use_memory(a->size());
+          prev = a;
+        }
+        else
+        {
+          if (prev == nullptr)
+            first_arena = q;
+          else
+            prev->next = q;
+
+          if (last_arena == a)
+            last_arena = prev;
+
+          uncount_arena(a->size());
+          Arena::dealloc(alloc, a);
+        }
+
+        a = q;
       }
     }
 
@@ -573,17 +1540,153 @@ namespace verona::rt
 
       Systematic::cout() << "Region release: trace region: " << o << std::endl;
 
+      // Objects left over from an incremental collection are in the middle of
+      // being swept, so finish that off first.
+      finish_sweep(alloc, o, f, collect);
+
       // Sweep everything, including the entrypoint.
       sweep<SweepAll::Yes>(alloc, o, f, collect, 0);
 
       dealloc(alloc);
     }
 
+    /**
+     * Deallocate this region metadata object, and the objects kept in its
+     * free lists.
+     **/
+    inline void dealloc(Alloc* alloc)
+    {
+      release_side_tables(alloc);
+      RegionBase::dealloc(alloc);
+    }
+
+    /**
+     * Release the free lists and the objects written to, which the region
+     * keeps alongside its ExternalReferenceTable and RememberedSet.
+     **/
+    void release_side_tables(Alloc* alloc)
+    {
+      release_free_lists(alloc);
+
+      if (written != nullptr)
+      {
+        written->~ObjectStack();
+        alloc->dealloc<sizeof(ObjectStack)>(written);
+        written = nullptr;
+      }
+    }
+
+    /**
+     * Deallocate the swept object `p`, or keep it in a free list to be
+     * recycled by `reuse`. Nothing is kept when the whole region is being
+     * released.
+     **/
+    template<SweepAll sweep_all>
+    void recycle(Alloc* alloc, Object* p)
+    {
+      size_t size = p->size();
+      auto& fp = free_list_policy();
+
+      if constexpr (sweep_all == SweepAll::No)
+      {
+        if (fp.enabled && (size <= FREE_LIST_MAX_SIZE))
+        {
+          sizeclass_t sc = size_to_sizeclass(size);
+          size_t block = sizeclass_to_size(sc);
+
+          if (free_list_bytes + block <= fp.max_bytes)
+          {
+            if (free_lists == nullptr)
+            {
+              free_lists = (void**)alloc->alloc<YesZero>(
+                free_list_classes() * sizeof(void*));
+            }
+
+            *(void**)p = free_lists[sc];
+            free_lists[sc] = p;
+            free_list_bytes += block;
+            return;
+          }
+        }
+      }
+
+      p->dealloc(alloc);
+    }
+
+    /**
+     * Returns a block from the free list for objects of `size` bytes, or
+     * nullptr if there is none.
+     **/
+    void* reuse(size_t size)
+    {
+      if ((free_lists == nullptr) || (size > FREE_LIST_MAX_SIZE))
+        return nullptr;
+
+      sizeclass_t sc = size_to_sizeclass(size);
+      void* p = free_lists[sc];
+
+      if (p != nullptr)
+      {
+        free_lists[sc] = *(void**)p;
+        free_list_bytes -= sizeclass_to_size(sc);
+      }
+
+      return p;
+    }
+
+    /**
+     * Hand every block in the free lists back to snmalloc.
+     **/
+    void release_free_lists(Alloc* alloc)
+    {
+      if (free_lists == nullptr)
+        return;
+
+      size_t classes = free_list_classes();
+      for (size_t i = 0; i < classes; i++)
+      {
+        size_t block = sizeclass_to_size((sizeclass_t)i);
+        void* p = free_lists[i];
+        while (p != nullptr)
+        {
+          void* q = *(void**)p;
+          alloc->dealloc(p, block);
+          p = q;
+        }
+      }
+
+      alloc->dealloc(free_lists, classes * sizeof(void*));
+      free_lists = nullptr;
+      free_list_bytes = 0;
+    }
+
+    static size_t free_list_classes()
+    {
+      return size_to_sizeclass(FREE_LIST_MAX_SIZE) + 1;
+    }
+
     void use_memory(size_t size)
     {
       current_memory_used += size;
     }
 
+    /**
+     * Whether this region has grown enough since its last collection to be
+     * worth collecting again.
+     **/
+    bool should_gc()
+    {
+      auto& g = generational_policy();
+      if (g.enabled && (nursery_memory >= g.nursery_bytes))
+        return true;
+
+      auto& p = policy();
+      size_t previous = sizeclass_to_size(previous_memory_used);
+      size_t threshold = (previous / 100) * p.growth_percent;
+
+      return current_memory_used >= std::max(threshold, p.min_bytes);
+    }
+
   public:
     template<IteratorType type = AllObjects>
     class iterator
@@ -593,7 +1696,8 @@ namespace verona::rt
       static_assert(
         type == Trivial || type == NonTrivial || type == AllObjects);
 
-      iterator(RegionTrace* r) : reg(r)
+      iterator(RegionTrace* r)
+      : reg(r), arena(nullptr), in_arena(RegionArena::arena_end<type>())
       {
         Object* q = r->get_next();
         if constexpr (type == Trivial)
@@ -604,16 +1708,31 @@ namespace verona::rt
           ptr = q;
 
         // If the next object is the region metadata object, then there was
-        // nothing to iterate over.
+        // nothing to iterate over in the rings.
         if (ptr == r)
-          ptr = nullptr;
+          first_in_arenas(r->first_arena);
       }
 
-      iterator(RegionTrace* r, Object* p) : reg(r), ptr(p) {}
+      iterator(RegionTrace* r, Object* p)
+      : reg(r),
+        ptr(p),
+        arena(nullptr),
+        in_arena(RegionArena::arena_end<type>())
+      {}
 
     public:
       iterator operator++()
       {
+        if (arena != nullptr)
+        {
+          // Currently iterating through an adopted arena.
+          ++in_arena;
+          ptr = *in_arena;
+          if (ptr == nullptr)
+            first_in_arenas(arena->next);
+          return *this;
+        }
+
         Object* q = ptr->get_next_any_mark();
         if (q != reg)
         {
@@ -632,14 +1751,14 @@ namespace verona::rt
           }
           else
           {
-            // We finished the secondary ring, so we're done.
-            ptr = nullptr;
+            // We finished the secondary ring, so go on to the arenas.
+            first_in_arenas(reg->first_arena);
           }
         }
         else
         {
           // We finished a ring and don't care about the other ring.
-          ptr = nullptr;
+          first_in_arenas(reg->first_arena);
         }
         return *this;
       }
@@ -658,6 +1777,32 @@ namespace verona::rt
     private:
       RegionTrace* reg;
       Object* ptr;
+
+      // The adopted arena being iterated through, if the rings are done.
+      Arena* arena;
+      RegionArena::iterator<type> in_arena;
+
+      /**
+       * Starting from the adopted arena `a`, set `ptr` to the first
+       * appropriate object, or to nullptr if there is none.
+       **/
+      void first_in_arenas(Arena* a)
+      {
+        while (a != nullptr)
+        {
+          in_arena = RegionArena::arena_begin<type>(a);
+          ptr = *in_arena;
+          if (ptr != nullptr)
+          {
+            arena = a;
+            return;
+          }
+          a = a->next;
+        }
+
+        arena = nullptr;
+        ptr = nullptr;
+      }
     };
 
     template<IteratorType type = AllObjects>
@@ -683,4 +1828,15 @@ namespace verona::rt
       return false;
     }
   };
+
+  namespace region
+  {
+    inline void merge_trace(Alloc* alloc, RegionArena* into, Object* o)
+    {
+      RegionTrace::finish_gc(alloc, o);
+      RegionTrace* reg = RegionTrace::get(o);
+      reg->release_side_tables(alloc);
+      reg->move_to_arena(into, o);
+    }
+  } // namespace region
 } // namespace verona::rt
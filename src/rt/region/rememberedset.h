@@ -82,6 +82,11 @@ namespace verona::rt
       alloc->dealloc<sizeof(HashSet)>(hash_set);
     }
 
+    size_t remembered_count() const
+    {
+      return hash_set->size();
+    }
+
     void merge(Alloc* alloc, RememberedSet* that)
     {
       for (auto& e : *that->hash_set)
@@ -143,6 +148,14 @@ namespace verona::rt
       {
         assert(entry.o == nullptr);
         o->incref();
+
+        // Inserting may have grown the set, which moves every entry, so find
+        // the new one again. This cannot grow the set, as it is present.
+        HashSetEntry again{o};
+        bool added = hash_set->insert(alloc, again, index);
+        assert(!added);
+        UNUSED(added);
+        again.o = nullptr;
       }
       else
       {
@@ -32,8 +32,20 @@ namespace verona::rt
 #endif
   }
 
+  /**
+   * Whether a send is slowed down when a receiver is overloaded, if
+   * back-pressure is enabled. See `ThreadPool::set_back_pressure`.
+   **/
+  enum BackPressure
+  {
+    NoBackPressure,
+    YesBackPressure
+  };
+
   class Cown : public Object
   {
+    // Used instead of the cycle budget under systematic testing, where time
+    // is not deterministic.
     static constexpr size_t BATCH_COUNT = 100;
 
   public:
@@ -54,13 +66,16 @@ namespace verona::rt
     template<typename T>
     friend class SPMCQ;
 
+    template<typename T>
+    friend class InjectQueue;
+
     static constexpr auto NO_EPOCH_SET = (std::numeric_limits<uint64_t>::max)();
 
-    union
-    {
-      std::atomic<Cown*> next_in_queue;
-      uint64_t epoch_when_popped = NO_EPOCH_SET;
-    };
+    // These do not share space: a popped cown keeps its last link, so that a
+    // thief walking a batch in `SPMCQ::dequeue_batch` never follows an epoch
+    // as if it were a pointer.
+    std::atomic<Cown*> next_in_queue{nullptr};
+    uint64_t epoch_when_popped = NO_EPOCH_SET;
 
     // Five pointer overhead compared to an object.
     verona::rt::MPSCQ<MultiMessage> queue;
@@ -70,7 +85,12 @@ namespace verona::rt
     // If the object is collected by the leak detector, we should not
     // collect again when the weak reference count hits 0.
     std::atomic<uintptr_t> thread_status;
+
+    // Links in the owning scheduler thread's list of cowns, and in its list
+    // of stubs to collect once the weak count has reached zero.
     Cown* next;
+    Cown* prev;
+    Cown* next_stub;
 
     /**
      * Cown's weak reference count.  This keeps the cown itself alive, but not
@@ -92,7 +112,9 @@ namespace verona::rt
     }
 
     static constexpr uintptr_t collected_mask = 1;
-    static constexpr uintptr_t thread_mask = ~collected_mask;
+    static constexpr uintptr_t overloaded_mask = 2;
+    static constexpr uintptr_t thread_mask =
+      ~(collected_mask | overloaded_mask);
 
     void set_owning_thread(SchedulerThread<Cown>* owner)
     {
@@ -110,6 +132,69 @@ namespace verona::rt
         0;
     }
 
+    /**
+     * Record whether this cown has more messages queued than it can process
+     * in one batch. Only tracked if back-pressure is enabled.
+     **/
+    void set_overloaded(bool overloaded)
+    {
+      if (!Scheduler::get_back_pressure() || (overloaded == is_overloaded()))
+        return;
+
+      if (overloaded)
+      {
+        Systematic::cout() << "Cown overloaded: " << this << std::endl;
+        thread_status |= overloaded_mask;
+      }
+      else
+      {
+        Systematic::cout() << "Cown no longer overloaded: " << this
+                           << std::endl;
+        thread_status &= ~overloaded_mask;
+        Scheduler::capacity_available();
+      }
+    }
+
+    bool is_overloaded()
+    {
+      return (thread_status.load(std::memory_order_relaxed) &
+              overloaded_mask) != 0;
+    }
+
+    /**
+     * Slow down a sender if back-pressure is enabled and one of the `count`
+     * receivers in `cowns` is overloaded.
+     *
+     * A behaviour cannot be stopped part way through, so the scheduler thread
+     * instead mutes its cown once the behaviour completes. An external thread
+     * has nothing to mute, so it blocks here until the receiver catches up,
+     * for a bounded time.
+     **/
+    static void back_pressure(size_t count, Cown** cowns)
+    {
+      if (!Scheduler::get_back_pressure())
+        return;
+
+      for (size_t i = 0; i < count; i++)
+      {
+        Cown* c = cowns[i];
+
+        if (!c->is_overloaded())
+          continue;
+
+        auto local = Scheduler::local();
+        if (local != nullptr)
+        {
+          local->sent_to_overloaded(c);
+          return;
+        }
+
+        Systematic::cout() << "External send to overloaded cown: " << c
+                           << std::endl;
+        Scheduler::wait_for_capacity([c]() { return !c->is_overloaded(); });
+      }
+    }
+
     SchedulerThread<Cown>* owning_thread()
     {
       return (
@@ -265,6 +350,18 @@ namespace verona::rt
       // During teardown don't recursively delete.
       if (Scheduler::is_teardown_in_progress())
       {
+        // A cown that has never run is not owned by any thread, so it was not
+        // collected in phase 1, and no thread will collect its stub in phase
+        // 2. This happens when the last reference to it is released by an
+        // epoch flushed during teardown.
+        if (a->owning_thread() == nullptr)
+        {
+          if (!collect_not_required)
+            a->collect(alloc);
+          a->weak_release(alloc);
+          return;
+        }
+
         // If we call weak_release here, the object will be fully collected
         // as the thread field may have been nulled during teardown.  Just
         // remove weak count, so that we collect stub in teardown phase 2.
@@ -283,7 +380,8 @@ namespace verona::rt
             << "Not performing recursive deallocation on: " << o << std::endl;
           // The cown may have already been swept, just remove weak count, let
           // sweeping/cown stub collection deal with the rest.
-          a->weak_count.fetch_sub(1);
+          if ((a->weak_count.fetch_sub(1) == 1) && (a->owning_thread()))
+            a->owning_thread()->release_stub(a);
           return;
         }
       }
@@ -321,7 +419,7 @@ namespace verona::rt
           e.add_pressure();
         }
         // Tell owning thread that it has a free cown to collect.
-        t->free_cowns++;
+        t->release_stub(this);
         yield();
       }
     }
@@ -386,15 +484,13 @@ namespace verona::rt
 
       if (local != nullptr)
       {
-        set_owning_thread(local);
-        next = local->list;
-        local->list = this;
-        local->total_cowns++;
+        local->add_cown(this);
       }
       else
       {
         set_owning_thread(nullptr);
         next = nullptr;
+        prev = nullptr;
       }
     }
 
@@ -412,6 +508,12 @@ namespace verona::rt
         return;
       }
 
+      if (Scheduler::get_inject_external())
+      {
+        Scheduler::inject(this);
+        return;
+      }
+
       // TODO this should be checked further up the stack.
       // TODO Make this assertion pass.
       // assert(can_lifo_schedule() || Scheduler::debug_not_running());
@@ -420,6 +522,24 @@ namespace verona::rt
       t->schedule_lifo(this);
     }
 
+    /**
+     * Schedule a cown that a message from the running behaviour has just
+     * woken. On a scheduler thread it is run next, while the data the sender
+     * touched is still in cache.
+     **/
+    void schedule_next()
+    {
+      CownThread* t = Scheduler::local();
+
+      if (t != nullptr)
+      {
+        t->schedule_next(this);
+        return;
+      }
+
+      schedule();
+    }
+
   private:
     bool in_epoch(EpochMark epoch)
     {
@@ -452,6 +572,7 @@ namespace verona::rt
       if (!cown_scanned(epoch))
       {
         cown_mark_scanned();
+        Scheduler::local()->stats.ld_scanned();
 
         ObjectStack f(alloc);
         trace(f);
@@ -491,6 +612,52 @@ namespace verona::rt
       }
     }
 
+    /**
+     * Collect any trace regions held directly by this cown that have grown
+     * enough since they were last collected, and carry on with any of their
+     * incremental collections. We must be running on this cown.
+     **/
+    void gc_regions(Alloc* alloc)
+    {
+      ObjectStack f(alloc);
+      trace(f);
+
+      while (!f.empty())
+      {
+        Object* o = f.pop();
+
+        if (
+          (o->get_class() == RegionMD::ISO) &&
+          RegionTrace::is_trace_region(o->get_region()))
+        {
+          uint64_t pause = RegionTrace::gc_if_grown(alloc, o);
+          if (pause != 0)
+            Scheduler::local()->stats.gc_pause(pause);
+        }
+      }
+    }
+
+    /**
+     * Hand the memory kept in the free lists of the trace regions held
+     * directly by this cown back to snmalloc. We must be running on this
+     * cown.
+     **/
+    void trim_regions(Alloc* alloc)
+    {
+      ObjectStack f(alloc);
+      trace(f);
+
+      while (!f.empty())
+      {
+        Object* o = f.pop();
+
+        if (
+          (o->get_class() == RegionMD::ISO) &&
+          RegionTrace::is_trace_region(o->get_region()))
+          RegionTrace::trim_free_lists(alloc, o);
+      }
+    }
+
     void cown_notified()
     {
       notified();
@@ -514,10 +681,9 @@ namespace verona::rt
      *     message.
      * (2) We sent the message to the last cown. There are no further cowns to
      *     acquire, so we schedule the last cown so it can handle the
-     *     multimessage action.
-     *     TODO: It would be semantically valid to execute the action without
-     *     rescheduling. However, for fairness, it is better to reschedule in
-     *     case the action executes for a very long time.
+     *     multimessage action. Within the inline budget, it is handed to this
+     *     thread to run as soon as the current behaviour's cown returns. It is
+     *     never run nested inside the current behaviour.
      **/
     static void fast_send(MultiMessage::MultiMessageBody* body, EpochMark epoch)
     {
@@ -549,10 +715,17 @@ namespace verona::rt
           // Case 2: acquired the last cown.
           Systematic::cout()
             << "MultiMessage fast acquired " << cowns[body->index] << std::endl;
+
+          // Run the behaviour as soon as the sender's cown returns, rather
+          // than behind everything else in the queue.
+          CownThread* t = Scheduler::local();
+          if ((t != nullptr) && t->schedule_after(cowns[body->index]))
+            return;
+
           Systematic::cout()
             << "MultiMessage fast send completed, rescheduling cown "
             << cowns[body->index] << std::endl;
-          cowns[body->index]->schedule();
+          cowns[body->index]->schedule_next();
           return;
         }
 
@@ -618,8 +791,11 @@ namespace verona::rt
           // phases.  We can also see messages sent by threads that have made it
           // into PreScan before us. But the global state must be PreScan, we
           // just haven't moved into it yet. `debug_in_prescan` accounts for
-          // either the local or the global state is prescan.
-          assert(Scheduler::should_scan() || Scheduler::debug_in_prescan());
+          // either the local or the global state is prescan. Messages from
+          // outside the pool are the exception, and are already counted.
+          assert(
+            Scheduler::should_scan() || Scheduler::debug_in_prescan() ||
+            (e == EpochMark::EPOCH_NONE));
 
           if (e != EpochMark::EPOCH_NONE)
           {
@@ -693,6 +869,16 @@ namespace verona::rt
       Systematic::cout() << "MultiMessage " << m << " completed and running on "
                          << cown << std::endl;
 
+      // The end of a behaviour is a safe point to collect the regions owned
+      // by the cowns it ran on, if one of them has grown enough, or to sweep
+      // some more of an incremental collection. Each region is checked, as
+      // it may have grown while held elsewhere, such as in a message.
+      if (RegionTrace::get_auto_gc() || RegionTrace::sweeps_pending())
+      {
+        for (size_t i = 0; i < body.count; i++)
+          body.cowns[i]->gc_regions(alloc);
+      }
+
       // Reschedule all the cowns.
       for (size_t i = 0; i < last; i++)
         body.cowns[i]->schedule();
@@ -709,10 +895,11 @@ namespace verona::rt
     template<
       class Behaviour,
       TransferOwnership transfer = NoTransfer,
+      BackPressure pressure = YesBackPressure,
       typename... Args>
     static void schedule(Cown* cown, Args&&... args)
     {
-      schedule<Behaviour, transfer, Args...>(
+      schedule<Behaviour, transfer, pressure, Args...>(
         1, &cown, std::forward<Args>(args)...);
     }
 
@@ -722,10 +909,14 @@ namespace verona::rt
      * Pass `transfer = YesTransfer` as a template argument if the
      * caller is transfering ownership of a reference count on each cown to this
      * method.
+     *
+     * Pass `pressure = NoBackPressure` if this send must never be slowed
+     * down by an overloaded receiver.
      **/
     template<
       class Behaviour,
       TransferOwnership transfer = NoTransfer,
+      BackPressure pressure = YesBackPressure,
       typename... Args>
     static void schedule(size_t count, Cown** cowns, Args&&... args)
     {
@@ -752,14 +943,17 @@ namespace verona::rt
           Cown::acquire(sort[i]);
       }
 
+      if constexpr (pressure == YesBackPressure)
+        back_pressure(count, sort);
+
       auto body = MultiMessage::make_body(alloc, count, sort, action);
 
-      // TODO what if this thread is external.
-      //  EPOCH_A okay as currently only sending externally, before we start
-      //  and thus its okay.
+      // Messages from outside the pool are counted as inflight once the
+      // runtime is running.
       //  Need to use another value when we add pinned cowns.
       auto sched = Scheduler::local();
-      auto epoch = sched == nullptr ? EpochMark::EPOCH_A : Scheduler::epoch();
+      auto epoch =
+        sched == nullptr ? Scheduler::external_epoch() : Scheduler::epoch();
 
       if (epoch == EpochMark::EPOCH_NONE)
       {
@@ -795,8 +989,16 @@ namespace verona::rt
       auto notified_called = false;
       auto notify = false;
 
-      // Handle up to BATCH_COUNT messages.
-      for (size_t n = 0; n < BATCH_COUNT; n++)
+      uint64_t budget = get_descriptor()->batch_budget;
+      if (budget == 0)
+        budget = Scheduler::get_batch_budget();
+      uint64_t start = Aal::tick();
+
+      // Handle messages until we run out of budget. The number of messages
+      // in a batch follows from how long they take, so cowns with small
+      // behaviours are rescheduled less often, and cowns with long ones
+      // yield sooner.
+      for (size_t n = 0;; n++)
       {
         assert(!queue.is_sleeping());
 
@@ -810,6 +1012,8 @@ namespace verona::rt
 
         if (curr == nullptr)
         {
+          set_overloaded(false);
+
           if (Scheduler::should_scan())
           {
             // We have hit null, and we should scan, then we know
@@ -840,6 +1044,12 @@ namespace verona::rt
           if (n != 0)
             return true;
 
+          // Nothing has arrived for a whole batch, so this cown is idle. Its
+          // regions hand back their free lists before it goes to sleep, after
+          // which another thread may run it.
+          if (RegionTrace::get_free_lists())
+            trim_regions(alloc);
+
           // Reschedule if cown does not go to sleep.
           if (!queue.mark_sleeping(notify))
             return true;
@@ -869,13 +1079,40 @@ namespace verona::rt
         // cown's queue should not be marked as empty, even if it is.
         if (!run_step(curr))
         {
+          // This cown is now waiting for a multimessage to acquire other
+          // cowns, which may be held back for sending to it. It cannot catch
+          // up on its own, so let them go.
+          set_overloaded(false);
           return false;
         }
 
         // If we hit the end then tell scheduler thread to reschedule this cown.
-        // TODO Back pressure, this should trigger back pressure on this cown.
         if (curr == until)
         {
+          // Only caught up if nothing has arrived since the batch started.
+          if (is_overloaded() && (queue.peek_back() == until))
+            set_overloaded(false);
+          Scheduler::local()->stats.batch(n + 1, false);
+          break;
+        }
+
+        if (batch_expired(n + 1, start, budget))
+        {
+          Systematic::cout()
+            << "Batch budget expired after " << (n + 1) << " messages on "
+            << this << std::endl;
+          // There is a backlog of messages that were already queued when
+          // this batch started, so ask senders to back off.
+          set_overloaded(true);
+          Scheduler::local()->stats.batch(n + 1, true);
+          break;
+        }
+
+        // Give the receiver a chance to catch up, rather than continue to
+        // send to it.
+        if (Scheduler::local()->mute_target != nullptr)
+        {
+          Scheduler::local()->stats.batch(n + 1, false);
           break;
         }
       }
@@ -883,6 +1120,18 @@ namespace verona::rt
       return true;
     }
 
+    static bool batch_expired(size_t count, uint64_t start, uint64_t budget)
+    {
+#ifdef USE_SYSTEMATIC_TESTING
+      UNUSED(start);
+      UNUSED(budget);
+      return count >= BATCH_COUNT;
+#else
+      UNUSED(count);
+      return (Aal::tick() - start) >= budget;
+#endif
+    }
+
     bool try_collect(Alloc* alloc, EpochMark epoch)
     {
       Systematic::cout() << "try_collect: " << this << " (" << get_epoch_mark()
@@ -996,6 +1245,21 @@ namespace verona::rt
       Cown::mark_for_scan(o, epoch);
     }
   } // namespace cown
+
+  namespace scheduler
+  {
+    inline void unpause()
+    {
+      Scheduler::wake_idle_thread();
+    }
+
+    inline void yield()
+    {
+#ifdef USE_SYSTEMATIC_TESTING
+      Scheduler::yield_my_turn();
+#endif
+    }
+  } // namespace scheduler
 } // namespace verona::rt
 
 namespace Systematic
@@ -5,6 +5,7 @@
 #include <snmalloc.h>
 
 #if defined(__linux__)
+#  include <dirent.h>
 #  include <sched.h>
 #  include <stdio.h>
 #  include <stdlib.h>
@@ -29,11 +30,49 @@
 #endif
 
 #include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <vector>
 
 namespace verona::rt
 {
   using namespace snmalloc;
+
+  /**
+   * Policy used to map scheduler threads onto CPUs.
+   **/
+  enum class Placement
+  {
+    // Use every physical core before any hyperthread, and fill one package
+    // before moving on to the next.  This keeps communicating threads close.
+    Compact,
+
+    // Use every physical core before any hyperthread, but alternate between
+    // packages.  This spreads the load over all sockets and memory controllers.
+    Scatter,
+
+    // Do not pin scheduler threads to CPUs, and leave placement to the OS.
+    Unpinned,
+  };
+
+  /**
+   * How far apart two CPUs are, from closest to furthest.  Used to prefer
+   * stealing work from threads that share caches with the thief.
+   **/
+  enum class Distance : uint8_t
+  {
+    // Hyperthreads of the same physical core, or the same CPU.
+    Sibling,
+    // Different cores of the same package.
+    Package,
+    // Different packages attached to the same NUMA node.
+    Node,
+    // Different NUMA nodes.
+    Remote,
+  };
+
+  static constexpr size_t DISTANCE_COUNT = (size_t)Distance::Remote + 1;
+
   class Topology
   {
   private:
@@ -43,6 +82,8 @@ namespace verona::rt
       size_t package;
       size_t group;
       size_t id;
+      // Identifies the physical core. Hyperthreads of the same core share it.
+      size_t core;
       bool hyperthread;
 
       size_t get()
@@ -87,6 +128,7 @@ namespace verona::rt
     };
 
     std::vector<CPU>* cpus = nullptr;
+    Placement placement = Placement::Compact;
 
 #if defined(CPU_COUNT) && defined(CPU_ISSET)
     template<typename CPUSet>
@@ -99,12 +141,11 @@ namespace verona::rt
       uint32_t index = 0;
       uint32_t found = 0;
 
-      // TODO: CPU topology detection for Linux
       while (found < count)
       {
         if (CPU_ISSET(index, &all_cpus))
         {
-          cpus->push_back(CPU{0, 0, 0, index, false});
+          cpus->push_back(CPU{0, 0, 0, index, index, false});
           found++;
         }
 
@@ -113,16 +154,207 @@ namespace verona::rt
     }
 #endif
 
+#if defined(__linux__)
+    /**
+     * Read a single unsigned integer from a sysfs file. Returns false if the
+     * file is not present, for example in a container that hides sysfs.
+     **/
+    static bool read_sysfs_value(const char* path, size_t& value)
+    {
+      FILE* f = fopen(path, "r");
+      if (f == nullptr)
+        return false;
+
+      unsigned long v;
+      bool ok = fscanf(f, "%lu", &v) == 1;
+      fclose(f);
+
+      if (ok)
+        value = v;
+
+      return ok;
+    }
+
+    /**
+     * Read a sysfs CPU list file, and call `apply` with every CPU index in it.
+     **/
+    static void
+    read_sysfs_cpulist(const char* path, std::function<void(size_t)> apply)
+    {
+      FILE* f = fopen(path, "r");
+      if (f == nullptr)
+        return;
+
+      char list[4096];
+      size_t len = fread(list, 1, sizeof(list) - 1, f);
+      fclose(f);
+
+      list[len] = '\0';
+      parse_cpulist(list, apply);
+    }
+
+    /**
+     * Fill in the package, core, hyperthread and NUMA node of every CPU we
+     * may run on, from the sysfs tree at `sysfs`. Anything missing keeps the
+     * flat defaults.
+     **/
+    void read_linux_topology(const char* sysfs)
+    {
+      char path[256];
+
+      for (auto& cpu : *cpus)
+      {
+        snprintf(
+          path,
+          sizeof(path),
+          "%s/cpu/cpu%zu/topology/physical_package_id",
+          sysfs,
+          cpu.id);
+        read_sysfs_value(path, cpu.package);
+
+        // The lowest numbered thread sibling names the physical core.
+        snprintf(
+          path,
+          sizeof(path),
+          "%s/cpu/cpu%zu/topology/thread_siblings_list",
+          sysfs,
+          cpu.id);
+        read_sysfs_cpulist(path, [&cpu](size_t sibling) {
+          cpu.core = (std::min)(cpu.core, sibling);
+        });
+      }
+
+      // A CPU is a hyperthread if a lower numbered sibling of the same core is
+      // also available to us.  Siblings outside our affinity mask do not count.
+      for (auto& cpu : *cpus)
+      {
+        cpu.hyperthread = std::any_of(
+          cpus->begin(), cpus->end(), [&cpu](const CPU& that) {
+            return (that.core == cpu.core) && (that.id < cpu.id);
+          });
+      }
+
+      snprintf(path, sizeof(path), "%s/node", sysfs);
+      DIR* nodes = opendir(path);
+      if (nodes == nullptr)
+        return;
+
+      struct dirent* entry;
+      while ((entry = readdir(nodes)) != nullptr)
+      {
+        unsigned long node;
+        if (sscanf(entry->d_name, "node%lu", &node) != 1)
+          continue;
+
+        snprintf(path, sizeof(path), "%s/node/node%lu/cpulist", sysfs, node);
+        read_sysfs_cpulist(path, [this, node](size_t id) {
+          for (auto& cpu : *cpus)
+          {
+            if (cpu.id == id)
+              cpu.numa_node = node;
+          }
+        });
+      }
+
+      closedir(nodes);
+    }
+#endif
+
+    /**
+     * Reorder the CPUs, which are already sorted for `Placement::Compact`, so
+     * that consecutive entries alternate between packages.
+     **/
+    void scatter()
+    {
+      std::vector<std::pair<size_t, CPU>> ranked;
+      ranked.reserve(cpus->size());
+
+      // Rank each CPU by its position within its package.
+      for (auto& cpu : *cpus)
+      {
+        size_t rank = 0;
+        for (auto& r : ranked)
+        {
+          if (
+            (r.second.package == cpu.package) &&
+            (r.second.hyperthread == cpu.hyperthread))
+            rank++;
+        }
+        ranked.push_back({rank, cpu});
+      }
+
+      std::stable_sort(
+        ranked.begin(),
+        ranked.end(),
+        [](const std::pair<size_t, CPU>& a, const std::pair<size_t, CPU>& b) {
+          if (a.second.hyperthread != b.second.hyperthread)
+            return !a.second.hyperthread;
+
+          return a.first < b.first;
+        });
+
+      for (size_t i = 0; i < ranked.size(); i++)
+        cpus->at(i) = ranked[i].second;
+    }
+
+    /**
+     * Order the CPUs for the placement policy.
+     **/
+    void arrange()
+    {
+      std::sort(cpus->begin(), cpus->end());
+
+      if (placement == Placement::Scatter)
+        scatter();
+    }
+
   public:
     ~Topology()
     {
       release();
     }
 
-    void acquire()
+    /**
+     * Parse a CPU list, such as "0-3,8,10-11", and call `apply` with every
+     * CPU index in the list. Parsing stops at anything else.
+     **/
+    static void
+    parse_cpulist(const char* list, std::function<void(size_t)> apply)
+    {
+      const char* p = list;
+
+      while (true)
+      {
+        char* end;
+        unsigned long lo = strtoul(p, &end, 10);
+        if (end == p)
+          return;
+
+        unsigned long hi = lo;
+        p = end;
+
+        if (*p == '-')
+        {
+          hi = strtoul(p + 1, &end, 10);
+          if (end == p + 1)
+            return;
+          p = end;
+        }
+
+        for (unsigned long i = lo; i <= hi; i++)
+          apply(i);
+
+        if (*p != ',')
+          return;
+        p++;
+      }
+    }
+
+    void acquire(Placement placement_ = Placement::Compact)
     {
       delete cpus;
       cpus = new std::vector<CPU>;
+      placement = placement_;
 
 #if defined(_WIN32)
       size_t numa_count;
@@ -157,6 +389,7 @@ namespace verona::rt
                     get_package(group, id, package, package_count),
                     group,
                     id,
+                    i,
                     hyperthread});
 
               hyperthread = true;
@@ -174,6 +407,7 @@ namespace verona::rt
       get_cpuset<cpu_set_t>([](cpu_set_t& all_cpus) {
         sched_getaffinity(0, sizeof(cpu_set_t), &all_cpus);
       });
+      read_linux_topology("/sys/devices/system");
 #elif defined(FreeBSD_KERNEL)
       get_cpuset<cpuset_t>(
         [](cpuset_t& all_cpus) { CPU_COPY(cpuset_root, &all_cpus); });
@@ -196,15 +430,36 @@ namespace verona::rt
         cpus->reserve(core_count);
         for (uint32_t index = 0; index < core_count; index++)
         {
-          cpus->push_back(CPU{0, 0, 0, index, false});
+          cpus->push_back(CPU{0, 0, 0, index, index, false});
         }
       }
 #else
 #  error Missing CPU enumeration for your OS.
 #endif
 
-      std::sort(cpus->begin(), cpus->end());
+      arrange();
+    }
+
+#if defined(__linux__)
+    /**
+     * Build the topology from the CPUs `ids`, reading their layout from a
+     * copy of /sys/devices/system at `sysfs` rather than from this machine.
+     * Used to test placement against canned layouts.
+     **/
+    void debug_acquire(
+      Placement placement_, const std::vector<size_t>& ids, const char* sysfs)
+    {
+      delete cpus;
+      cpus = new std::vector<CPU>;
+      placement = placement_;
+
+      for (auto id : ids)
+        cpus->push_back(CPU{0, 0, 0, id, id, false});
+
+      read_linux_topology(sysfs);
+      arrange();
     }
+#endif
 
     void release()
     {
@@ -217,10 +472,40 @@ namespace verona::rt
       if ((cpus == nullptr) || (cpus->size() == 0))
         abort();
 
+      if (placement == Placement::Unpinned)
+        return (size_t)-1;
+
       index = index % cpus->size();
       return cpus->at(index).get();
     }
 
+    /**
+     * The distance between the CPUs that `get(a)` and `get(b)` return.
+     **/
+    Distance distance(size_t a, size_t b)
+    {
+      if ((cpus == nullptr) || (cpus->size() == 0))
+        abort();
+
+      // Nothing is known about where unpinned threads run.
+      if (placement == Placement::Unpinned)
+        return Distance::Node;
+
+      CPU& x = cpus->at(a % cpus->size());
+      CPU& y = cpus->at(b % cpus->size());
+
+      if ((x.group == y.group) && (x.core == y.core))
+        return Distance::Sibling;
+
+      if (x.package == y.package)
+        return Distance::Package;
+
+      if (x.numa_node == y.numa_node)
+        return Distance::Node;
+
+      return Distance::Remote;
+    }
+
     size_t size()
     {
       if ((cpus == nullptr) || (cpus->size() == 0))
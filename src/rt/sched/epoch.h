@@ -66,6 +66,27 @@ namespace verona::rt
     }
   };
 
+  /**
+   * How much deferred work is waiting for the epoch to advance, and how long
+   * threads wait for it. See `Epoch::get_stats`.
+   **/
+  struct EpochStats
+  {
+    // Advances of the global epoch, and those made because a thread's backlog
+    // reached the cap.
+    size_t advances = 0;
+    size_t forced = 0;
+    // Deletes and decrefs deferred and not yet run, summed over threads.
+    size_t backlog = 0;
+    // The largest backlog any one thread has held.
+    size_t max_backlog = 0;
+    // Cycles from a thread first wanting the epoch to advance until its epoch
+    // moved on, summed over `waits`, and the longest of them.
+    uint64_t advance_cycles = 0;
+    uint64_t max_advance_cycles = 0;
+    size_t waits = 0;
+  };
+
   class LocalEpoch : public Pooled<LocalEpoch>
   {
   private:
@@ -80,23 +101,83 @@ namespace verona::rt
       Object* o;
     };
 
+    /**
+     * References to a hot immutable or cown that this thread has taken out
+     * in advance. See `Epoch::acquire_hot`.
+     **/
+    struct HotRef
+    {
+      Object* o = nullptr;
+      size_t reserve = 0;
+    };
+
     friend class ThreadLocalEpoch;
     friend class Epoch;
 
+    struct Policy
+    {
+      size_t max_backlog = 8192;
+    };
+
+    struct State
+    {
+      std::atomic<size_t> advances = 0;
+      std::atomic<size_t> forced = 0;
+    };
+
+    // Work an epoch gathers before advancing is worth checking every thread.
+    static constexpr size_t ADVANCE_WORK = 128;
+    // Work in the current epoch at which threads still in the previous epoch
+    // are ejected.
+    static constexpr size_t URGENT_WORK = 1024;
+    // Hot objects that each thread keeps references in reserve for, and how
+    // many references it takes out at a time.
+    static constexpr size_t HOT_SLOTS = 16;
+    static constexpr size_t HOT_BATCH = 64;
+
     Queue<InnerNode> delete_list;
     Queue<InnerNode> dec_list;
-    // Providing heuristic for advancing the epoch. Currently, we only look at
-    // one slot to determine if we should advance the epoch (see
-    // advance_is_sensible()), but we keep the history here so that better
-    // heuristic could be applied later.
+    // The work deferred in each of the epochs this thread is holding entries
+    // for, used by advance_is_sensible() to see whether advances are keeping
+    // up.
     size_t pressure[4] = {0, 0, 0, 0};
     size_t unusable[4] = {0, 0, 0, 0};
     size_t to_dec[4] = {0, 0, 0, 0};
     uint8_t index = 0;
+    // Entries on delete_list and dec_list, and the limits on them, which are
+    // recalculated as the epoch advances.
+    size_t held = 0;
+    size_t max_held = 0;
+    size_t threshold = ADVANCE_WORK;
+    size_t cap = policy().max_backlog;
+    // When this thread first wanted the epoch to advance, or 0.
+    uint64_t wanted_tsc = 0;
+    // Indexed by the address of the object. Only used by the owning thread
+    // while it holds the epoch, or once no thread is using the epoch.
+    HotRef hot_refs[HOT_SLOTS];
 
     std::atomic<uint64_t> epoch = EJECTED_BIT;
     AsymmetricLock lock;
 
+    // Published by the owning thread for Epoch::get_stats.
+    std::atomic<size_t> backlog = 0;
+    std::atomic<size_t> max_backlog = 0;
+    std::atomic<uint64_t> advance_cycles = 0;
+    std::atomic<uint64_t> max_advance_cycles = 0;
+    std::atomic<size_t> waits = 0;
+
+    static Policy& policy()
+    {
+      static Policy policy;
+      return policy;
+    }
+
+    static State& state()
+    {
+      static State state;
+      return state;
+    }
+
     template<typename T, bool predicate(LocalEpoch* p, T t)>
     static bool forall(T t);
 
@@ -105,6 +186,7 @@ namespace verona::rt
       delete_list.enqueue((InnerNode*)p);
       (*get_unusable(2))++;
       (*get_pressure(2))++;
+      held++;
       debug_check_count();
     }
 
@@ -114,9 +196,25 @@ namespace verona::rt
       node->o = p;
       dec_list.enqueue((InnerNode*)node);
       (*get_to_dec(2))++;
+      held++;
       debug_check_count();
     }
 
+    /**
+     * Publish the backlog for Epoch::get_stats. It is largest just before an
+     * advance frees part of it, which is when this is called.
+     **/
+    void publish_backlog()
+    {
+      backlog.store(held, std::memory_order_relaxed);
+
+      if (held > max_held)
+      {
+        max_held = held;
+        max_backlog.store(max_held, std::memory_order_relaxed);
+      }
+    }
+
     inline void use_epoch(Alloc* a)
     {
       lock.internal_acquire();
@@ -157,9 +255,19 @@ namespace verona::rt
       return &to_dec[(index + i) & 3];
     }
 
+    /**
+     * Work deferred in the `i`th epoch of the history: deletes, decrefs, and
+     * anything else that asked for the epoch to advance.
+     **/
+    size_t get_work(uint8_t i)
+    {
+      return *get_pressure(i) + *get_to_dec(i);
+    }
+
     void advance_epoch(Alloc* alloc)
     {
       debug_check_count();
+      publish_backlog();
 
       {
         auto cell = get_unusable(0);
@@ -168,6 +276,7 @@ namespace verona::rt
         for (size_t n = 0; n < usable; n++)
           alloc->dealloc(delete_list.dequeue());
 
+        held -= usable;
         *cell = 0;
 
         *get_pressure(0) = 0;
@@ -186,10 +295,15 @@ namespace verona::rt
           Immutable::release(alloc, o);
         }
 
+        held -= usable;
         *cell = 0;
       }
 
       index = (index + 1) & 3;
+
+      threshold = advance_threshold();
+      cap = policy().max_backlog;
+      backlog.store(held, std::memory_order_relaxed);
     }
 
     void add_pressure()
@@ -197,22 +311,150 @@ namespace verona::rt
       (*get_pressure(2))++;
     }
 
-    // TODO: Add a proper heuristic here
+    static Object* hot_object(Object* o)
+    {
+      return o->debug_is_cown() ? o : o->immutable();
+    }
+
+    HotRef& get_hot_ref(Object* o)
+    {
+      return hot_refs[((uintptr_t)o / Object::ALIGNMENT) % HOT_SLOTS];
+    }
+
+    /**
+     * Take a reference to `o` from the reserve, topping the reserve up with a
+     * single atomic increment when it is empty.
+     **/
+    void acquire_hot(Alloc* alloc, Object* o)
+    {
+      o = hot_object(o);
+      auto& h = get_hot_ref(o);
+
+      if (h.o != o)
+      {
+        return_hot(alloc, h);
+        h.o = o;
+      }
+
+      if (h.reserve == 0)
+      {
+        Systematic::cout() << "Hot reserve refill: " << o << std::endl;
+        o->incref_many(HOT_BATCH);
+        h.reserve = HOT_BATCH;
+      }
+
+      h.reserve--;
+    }
+
+    /**
+     * Put a reference to `o` in the reserve. Beyond twice the batch size, a
+     * batch is handed back with a single atomic decrement.
+     **/
+    void release_hot(Alloc* alloc, Object* o)
+    {
+      o = hot_object(o);
+      auto& h = get_hot_ref(o);
+
+      if (h.o != o)
+      {
+        return_hot(alloc, h);
+        h.o = o;
+      }
+
+      h.reserve++;
+
+      if (h.reserve > 2 * HOT_BATCH)
+      {
+        o->decref_many(h.reserve - HOT_BATCH);
+        h.reserve = HOT_BATCH;
+      }
+    }
+
+    /**
+     * Hand back the whole reserve in `h`. The last reference is released as
+     * usual, so this may free the object.
+     **/
+    void return_hot(Alloc* alloc, HotRef& h)
+    {
+      Object* o = h.o;
+      size_t n = h.reserve;
+
+      // Clear the slot first, as releasing may run destructors that use it.
+      h.o = nullptr;
+      h.reserve = 0;
+
+      if (n == 0)
+        return;
+
+      Systematic::cout() << "Hot reserve return: " << o << " " << n
+                         << std::endl;
+
+      if (n > 1)
+        o->decref_many(n - 1);
+
+      if (o->debug_is_cown())
+        cown::release(alloc, (Cown*)o);
+      else
+        Immutable::release(alloc, o);
+    }
+
+    void flush_hot(Alloc* alloc)
+    {
+      for (auto& h : hot_refs)
+      {
+        if (h.o != nullptr)
+          return_hot(alloc, h);
+      }
+    }
+
+    /**
+     * Whether this thread holds so many entries that the epoch must advance,
+     * ejecting threads that hold it back where possible.
+     **/
+    bool over_cap()
+    {
+      return held >= cap;
+    }
+
+    /**
+     * How much work the current epoch should gather before advancing.
+     *
+     * The two earlier epochs are still waiting to be freed. When advances
+     * keep up, each holds about ADVANCE_WORK. When they hold more, because of
+     * a burst or because other threads were slow to move on, the threshold is
+     * lowered in proportion, so that the backlog is freed in fewer, quicker
+     * advances rather than waiting on ADVANCE_WORK more each time.
+     **/
+    size_t advance_threshold()
+    {
+      size_t waiting = get_work(0) + get_work(1);
+      size_t steady = 2 * ADVANCE_WORK;
+
+      if (waiting <= steady)
+        return ADVANCE_WORK;
+
+      return (ADVANCE_WORK * steady) / waiting;
+    }
+
     bool advance_is_sensible()
     {
+      if (over_cap())
+        return true;
 #ifdef USE_SYSTEMATIC_TESTING
       return coin(4);
 #else
-      return *get_pressure(2) > 128;
+      return get_work(2) > threshold;
 #endif
     }
 
     bool advance_is_urgent()
     {
+      if (held >= cap / 2)
+        return true;
 #ifdef USE_SYSTEMATIC_TESTING
       return coin(7);
 #else
-      return *get_pressure(2) > 1024;
+      return get_work(2) > URGENT_WORK;
 #endif
     }
 
@@ -224,6 +466,24 @@ namespace verona::rt
     NOINLINE
     void refresh_rare(Alloc* a, uint64_t old_epoch, uint64_t new_epoch)
     {
+      if (wanted_tsc != 0)
+      {
+        uint64_t cycles = Aal::tick() - wanted_tsc;
+        wanted_tsc = 0;
+
+        advance_cycles.store(
+          advance_cycles.load(std::memory_order_relaxed) + cycles,
+          std::memory_order_relaxed);
+        if (cycles > max_advance_cycles.load(std::memory_order_relaxed))
+          max_advance_cycles.store(cycles, std::memory_order_relaxed);
+        waits.store(
+          waits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      // Reconcile reserves with the shared counts once an epoch, so that an
+      // object is not kept alive by reserves for long after its last use.
+      flush_hot(a);
+
       advance_epoch(a);
 
       if (inc_epoch_by(old_epoch, 1) != new_epoch)
@@ -297,7 +557,7 @@ namespace verona::rt
       return false;
     }
 
-    void advance_global_epoch(bool try_eject)
+    bool advance_global_epoch(bool try_eject)
     {
       // Client must have already locked the epoch
       assert(lock.debug_internal_held());
@@ -308,17 +568,18 @@ namespace verona::rt
       if (try_eject)
       {
         if (!forall<uint64_t, not_in_epoch_try_eject>(e_prev))
-          return;
+          return false;
       }
       else
       {
         if (!forall<uint64_t, not_in_epoch>(e_prev))
-          return;
+          return false;
       }
 
       auto next_epoch = inc_epoch_by(e, 1);
       assert((GlobalEpoch::get() == e) || GlobalEpoch::get() == e + 1);
       GlobalEpoch::set(next_epoch);
+      return true;
     }
 
     void use_epoch_rare(Alloc* a, uint64_t old_epoch, uint64_t new_epoch)
@@ -339,7 +600,24 @@ namespace verona::rt
 
       if (advance_is_sensible())
       {
-        advance_global_epoch(advance_is_urgent());
+        if (wanted_tsc == 0)
+          wanted_tsc = Aal::tick();
+
+        publish_backlog();
+
+        bool forced = over_cap();
+        if (forced)
+        {
+          Systematic::cout() << "Epoch backlog at cap: " << held << std::endl;
+        }
+
+        if (advance_global_epoch(advance_is_urgent()))
+        {
+          state().advances++;
+          if (forced)
+            state().forced++;
+        }
+
         refresh(a);
       }
     }
@@ -363,6 +641,7 @@ namespace verona::rt
 
         assert(sum == dec_list.length());
       }
+      assert(held == delete_list.length() + dec_list.length());
 #endif
     }
   };
@@ -448,12 +727,88 @@ namespace verona::rt
       local_epoch->add_to_dec_list(alloc, object);
     }
 
+    /**
+     * Take a reference to the hot immutable or cown `o`, whose reference the
+     * caller already holds, without touching its shared count.
+     *
+     * Each thread takes references to a few hot objects out in batches, and
+     * hands them out and takes them back locally. The reserve is returned to
+     * the shared count as the epoch advances, so objects only used this way
+     * are freed an epoch or so after their last reference is dropped. The
+     * references are ordinary references: one taken here can be released
+     * with `Immutable::release` or `Cown::release` on any thread, and
+     * `release_hot` takes any reference.
+     *
+     * A thread that stops using the epoch keeps its reserves, and so the
+     * objects in them, until it uses the epoch again or the runtime is torn
+     * down.
+     **/
+    void acquire_hot(Object* o)
+    {
+      local_epoch->acquire_hot(alloc, o);
+    }
+
+    /**
+     * Release a reference to the hot immutable or cown `o` into this thread's
+     * reserve. See `acquire_hot`.
+     **/
+    void release_hot(Object* o)
+    {
+      local_epoch->release_hot(alloc, o);
+    }
+
     void flush_local()
     {
+      local_epoch->flush_hot(alloc);
+
       for (int i = 0; i < 4; i++)
         local_epoch->advance_epoch(alloc);
     }
 
+    /**
+     * Set how many deletes and decrefs one thread may defer before it forces
+     * the epoch to advance. From half of this, threads holding the epoch back
+     * are ejected where possible. It is a soft cap: a thread inside an
+     * `Epoch` cannot be ejected, so the backlog grows past the cap until it
+     * leaves.
+     **/
+    static void set_max_backlog(size_t max_backlog)
+    {
+      Systematic::cout() << "Set epoch max backlog: " << max_backlog
+                         << std::endl;
+      LocalEpoch::policy().max_backlog = max_backlog;
+    }
+
+    static size_t get_max_backlog()
+    {
+      return LocalEpoch::policy().max_backlog;
+    }
+
+    static EpochStats get_stats()
+    {
+      EpochStats stats;
+      stats.advances = LocalEpoch::state().advances;
+      stats.forced = LocalEpoch::state().forced;
+
+      auto curr = global_epoch_set().iterate();
+      while (curr != nullptr)
+      {
+        stats.backlog += curr->backlog.load(std::memory_order_relaxed);
+        stats.max_backlog = std::max(
+          stats.max_backlog, curr->max_backlog.load(std::memory_order_relaxed));
+        stats.advance_cycles +=
+          curr->advance_cycles.load(std::memory_order_relaxed);
+        stats.max_advance_cycles = std::max(
+          stats.max_advance_cycles,
+          curr->max_advance_cycles.load(std::memory_order_relaxed));
+        stats.waits += curr->waits.load(std::memory_order_relaxed);
+
+        curr = global_epoch_set().iterate(curr);
+      }
+
+      return stats;
+    }
+
     static void flush(Alloc* a)
     {
       // This should only be called when no threads are using the epoch, for
@@ -462,6 +817,8 @@ namespace verona::rt
 
       while (curr != nullptr)
       {
+        curr->flush_hot(a);
+
         for (int i = 0; i < 4; i++)
           curr->advance_epoch(a);
 
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include <atomic>
+
+namespace verona::rt
+{
+  /**
+   * Multiple Producer Multiple Consumer queue, used by threads outside the
+   * scheduler to hand over cowns that need running.
+   *
+   * Producers push onto a lock-free intrusive stack. Consumers never remove
+   * single elements: they take the whole stack with one exchange, so there
+   * is no ABA problem and no need for epochs. The stack is then reversed to
+   * give the elements in the order they were enqueued.
+   *
+   * The elements are linked through `next_in_queue`, which is free while a
+   * cown is waiting to be scheduled.
+   **/
+  template<class T>
+  class InjectQueue
+  {
+  private:
+    std::atomic<T*> head = nullptr;
+
+  public:
+    void enqueue(T* node)
+    {
+      T* h = head.load(std::memory_order_relaxed);
+      do
+      {
+        node->next_in_queue.store(h, std::memory_order_relaxed);
+      } while (!head.compare_exchange_weak(
+        h, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Remove every element. Returns the oldest, or nullptr if the queue was
+     * empty, and sets `last` to the newest. The elements are linked from
+     * oldest to newest through `next_in_queue`.
+     **/
+    T* dequeue_all(T*& last)
+    {
+      // Avoid taking the cache line exclusively if there is nothing to do.
+      if (is_empty())
+        return nullptr;
+
+      T* curr = head.exchange(nullptr, std::memory_order_acquire);
+      T* prev = nullptr;
+      last = curr;
+
+      while (curr != nullptr)
+      {
+        T* next = curr->next_in_queue.load(std::memory_order_relaxed);
+        curr->next_in_queue.store(prev, std::memory_order_relaxed);
+        prev = curr;
+        curr = next;
+      }
+
+      return prev;
+    }
+
+    bool is_empty()
+    {
+      return head.load(std::memory_order_relaxed) == nullptr;
+    }
+  };
+} // namespace verona::rt
@@ -16,6 +16,51 @@ namespace verona::rt
   class Noticeboard : public BaseNoticeboard
   {
   public:
+    /**
+     * The content of a noticeboard, read without taking a reference to it.
+     *
+     * The content is kept alive by holding the epoch until the borrow goes
+     * out of scope, rather than by its reference count, so reading a board
+     * does not write to the shared content. A borrow must stay on the stack
+     * of the behaviour that made it. Anything kept past that needs its own
+     * reference, from `incref` or `peek`.
+     *
+     * While any borrow is held, this thread holds back the epoch and so
+     * delays freeing anything deferred in it, by all threads. Borrows should
+     * be short, and must not be held across anything that waits on other
+     * threads.
+     **/
+    class Borrow
+    {
+    private:
+      friend class Noticeboard;
+
+      Epoch e;
+      T value;
+
+      Borrow(Alloc* alloc, const Noticeboard* board)
+      : e(alloc), value(board->template get<T>())
+      {
+        Systematic::cout() << "Borrow from noticeboard " << board << " value "
+                           << value << std::endl;
+        scan_read(alloc, value);
+      }
+
+    public:
+      Borrow(const Borrow&) = delete;
+      Borrow& operator=(const Borrow&) = delete;
+
+      T get() const
+      {
+        return value;
+      }
+
+      T operator->() const
+      {
+        return value;
+      }
+    };
+
     Noticeboard(T content_)
     {
       is_fundamental = std::is_fundamental_v<T>;
@@ -90,23 +135,39 @@ namespace verona::rt
             << "Inc ref from noticeboard peek" << local_content << std::endl;
           local_content->incref();
         }
-        // It's possible that the following three things happen:
-        // 1) cown is already Scanned,
-        // 2) the owner of the noticeboard is in PreScan,
-        // 3) the owner calls update
-        // This way, the old content of the noticeboard is never scanned.
-        // Intuitively, peek amounts to a way of receiving new msg, so it needs
-        // to be scanned.
-        if (Scheduler::should_scan())
-        {
-          Systematic::cout()
-            << "Scan from noticeboard peek" << local_content << std::endl;
-          ObjectStack f(alloc);
-          local_content->trace(f);
-          Cown::scan_stack(alloc, Scheduler::epoch(), f);
-        }
+        scan_read(alloc, local_content);
         return local_content;
       }
     }
+
+    /**
+     * Read the content without taking a reference to it. See `Borrow`.
+     **/
+    Borrow borrow(Alloc* alloc) const
+    {
+      static_assert(
+        !std::is_fundamental_v<T>, "Use peek to read fundamental values");
+      return Borrow(alloc, this);
+    }
+
+  private:
+    static void scan_read(Alloc* alloc, T local_content)
+    {
+      // It's possible that the following three things happen:
+      // 1) cown is already Scanned,
+      // 2) the owner of the noticeboard is in PreScan,
+      // 3) the owner calls update
+      // This way, the old content of the noticeboard is never scanned.
+      // Intuitively, reading a noticeboard amounts to a way of receiving new
+      // msg, so it needs to be scanned.
+      if (Scheduler::should_scan())
+      {
+        Systematic::cout() << "Scan from noticeboard read" << local_content
+                           << std::endl;
+        ObjectStack f(alloc);
+        local_content->trace(f);
+        Cown::scan_stack(alloc, Scheduler::epoch(), f);
+      }
+    }
   };
 } // namespace verona::rt
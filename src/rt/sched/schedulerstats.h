@@ -2,8 +2,12 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include "cpu.h"
+#include "threadstate.h"
+
 #include <iostream>
 #include <snmalloc.h>
+#include <string>
 
 namespace verona::rt
 {
@@ -11,11 +15,34 @@ namespace verona::rt
   class SchedulerStats
   {
   private:
+    // Region GC pauses are counted in buckets by powers of two of cycles,
+    // from below 2^GC_PAUSE_MIN_BITS up to 2^GC_PAUSE_MAX_BITS and over.
+    static constexpr size_t GC_PAUSE_MIN_BITS = 10;
+    static constexpr size_t GC_PAUSE_MAX_BITS = 26;
+    static constexpr size_t GC_PAUSE_BUCKETS =
+      GC_PAUSE_MAX_BITS - GC_PAUSE_MIN_BITS + 2;
+
 #ifdef USE_SCHED_STATS
     size_t steal_count = 0;
+    size_t steal_distance_count[DISTANCE_COUNT] = {};
+    size_t batch_count = 0;
+    size_t message_count = 0;
+    size_t batch_expired_count = 0;
+    size_t mute_count = 0;
+    size_t inject_count = 0;
+    size_t inline_count = 0;
     size_t pause_count = 0;
     std::atomic<size_t> unpause_count = 0;
-    std::atomic<size_t> lifo_count = 0;
+    size_t lifo_count = 0;
+    size_t lifo_hit_count = 0;
+    size_t deferred_release_count = 0;
+    size_t freeze_task_count = 0;
+    size_t cown_stub_count = 0;
+    size_t ld_round_count = 0;
+    size_t ld_scanned_count = 0;
+    size_t ld_collected_count = 0;
+    uint64_t ld_phase_cycles[LD_PHASE_COUNT] = {};
+    size_t gc_pause_count[GC_PAUSE_BUCKETS] = {};
 #endif
 
   public:
@@ -39,10 +66,53 @@ namespace verona::rt
       = default;
 #endif
 
-    void steal()
+    void steal(Distance distance)
     {
 #ifdef USE_SCHED_STATS
       steal_count++;
+      steal_distance_count[(size_t)distance]++;
+#else
+      UNUSED(distance);
+#endif
+    }
+
+    /**
+     * A cown processed `messages` messages before yielding to the scheduler,
+     * and `expired` says if that was because it ran out of budget.
+     **/
+    void batch(size_t messages, bool expired)
+    {
+#ifdef USE_SCHED_STATS
+      batch_count++;
+      message_count += messages;
+      if (expired)
+        batch_expired_count++;
+#else
+      UNUSED(messages);
+      UNUSED(expired);
+#endif
+    }
+
+    void mute()
+    {
+#ifdef USE_SCHED_STATS
+      mute_count++;
+#endif
+    }
+
+    void inject(size_t cowns)
+    {
+#ifdef USE_SCHED_STATS
+      inject_count += cowns;
+#else
+      UNUSED(cowns);
+#endif
+    }
+
+    void inline_run()
+    {
+#ifdef USE_SCHED_STATS
+      inline_count++;
 #endif
     }
 
@@ -60,10 +130,112 @@ namespace verona::rt
 #endif
     }
 
-    void lifo()
+    /**
+     * A cown left in a next-to-run slot either ran next on that thread (`hit`)
+     * or was displaced, deferred or stolen.
+     **/
+    void lifo(bool hit)
     {
 #ifdef USE_SCHED_STATS
       lifo_count++;
+      if (hit)
+        lifo_hit_count++;
+#else
+      UNUSED(hit);
+#endif
+    }
+
+    /**
+     * An idle thread released a graph, or part of one, left to it by
+     * DeferredRelease.
+     **/
+    void deferred_release()
+    {
+#ifdef USE_SCHED_STATS
+      deferred_release_count++;
+#endif
+    }
+
+    /**
+     * An idle thread helped with a freeze started on another thread.
+     **/
+    void freeze_task()
+    {
+#ifdef USE_SCHED_STATS
+      freeze_task_count++;
+#endif
+    }
+
+    /**
+     * The stubs of `count` cowns were collected.
+     **/
+    void cown_stubs(size_t count)
+    {
+#ifdef USE_SCHED_STATS
+      cown_stub_count += count;
+#else
+      UNUSED(count);
+#endif
+    }
+
+    /**
+     * This thread was the last to finish sweeping in a leak detector round.
+     **/
+    void ld_round()
+    {
+#ifdef USE_SCHED_STATS
+      ld_round_count++;
+#endif
+    }
+
+    /**
+     * A cown was scanned for the leak detector.
+     **/
+    void ld_scanned()
+    {
+#ifdef USE_SCHED_STATS
+      ld_scanned_count++;
+#endif
+    }
+
+    /**
+     * The leak detector collected `count` of this thread's cowns.
+     **/
+    void ld_collected(size_t count)
+    {
+#ifdef USE_SCHED_STATS
+      ld_collected_count += count;
+#else
+      UNUSED(count);
+#endif
+    }
+
+    /**
+     * This thread spent `cycles` in `phase` of a leak detector round.
+     **/
+    void ld_phase(LDPhase phase, uint64_t cycles)
+    {
+#ifdef USE_SCHED_STATS
+      ld_phase_cycles[(size_t)phase] += cycles;
+#else
+      UNUSED(phase);
+      UNUSED(cycles);
+#endif
+    }
+
+    /**
+     * A behaviour was held up for `cycles` by collecting regions at its end.
+     **/
+    void gc_pause(uint64_t cycles)
+    {
+#ifdef USE_SCHED_STATS
+      size_t bucket = 0;
+      while ((bucket + 1 < GC_PAUSE_BUCKETS) &&
+             (cycles >= ((uint64_t)1 << (bucket + GC_PAUSE_MIN_BITS))))
+        bucket++;
+      gc_pause_count[bucket]++;
+#else
+      UNUSED(cycles);
 #endif
     }
 
@@ -73,9 +245,28 @@ namespace verona::rt
 
 #ifdef USE_SCHED_STATS
       steal_count += that.steal_count;
+      batch_count += that.batch_count;
+      message_count += that.message_count;
+      batch_expired_count += that.batch_expired_count;
+      mute_count += that.mute_count;
+      inject_count += that.inject_count;
+      inline_count += that.inline_count;
+      for (size_t i = 0; i < DISTANCE_COUNT; i++)
+        steal_distance_count[i] += that.steal_distance_count[i];
       pause_count += that.pause_count;
       unpause_count += that.unpause_count;
       lifo_count += that.lifo_count;
+      lifo_hit_count += that.lifo_hit_count;
+      deferred_release_count += that.deferred_release_count;
+      freeze_task_count += that.freeze_task_count;
+      cown_stub_count += that.cown_stub_count;
+      ld_round_count += that.ld_round_count;
+      ld_scanned_count += that.ld_scanned_count;
+      ld_collected_count += that.ld_collected_count;
+      for (size_t i = 0; i < LD_PHASE_COUNT; i++)
+        ld_phase_cycles[i] += that.ld_phase_cycles[i];
+      for (size_t i = 0; i < GC_PAUSE_BUCKETS; i++)
+        gc_pause_count[i] += that.gc_pause_count[i];
 #endif
     }
 
@@ -94,13 +285,66 @@ namespace verona::rt
         csv << "SchedulerStats"
             << "DumpID"
             << "Steal"
+            << "StealSibling"
+            << "StealPackage"
+            << "StealNode"
+            << "StealRemote"
+            << "Batches"
+            << "Messages"
+            << "BatchExpired"
+            << "Mute"
+            << "Injected"
+            << "Inline"
             << "LIFO"
+            << "LIFOHit"
+            << "DeferredRelease"
+            << "FreezeTasks"
+            << "CownStubs"
             << "Pause"
             << "Unpause" << csv.endl;
       }
 
-      csv << "SchedulerStats" << dumpid << steal_count << lifo_count
+      csv << "SchedulerStats" << dumpid << steal_count
+          << steal_distance_count[(size_t)Distance::Sibling]
+          << steal_distance_count[(size_t)Distance::Package]
+          << steal_distance_count[(size_t)Distance::Node]
+          << steal_distance_count[(size_t)Distance::Remote] << batch_count
+          << message_count << batch_expired_count << mute_count
+          << inject_count << inline_count << lifo_count << lifo_hit_count
+          << deferred_release_count << freeze_task_count << cown_stub_count
           << pause_count << unpause_count << csv.endl;
+
+      if (dumpid == 0)
+      {
+        csv << "LeakDetector"
+            << "DumpID"
+            << "Rounds"
+            << "Scanned"
+            << "Collected"
+            << "PreScanCycles"
+            << "ScanCycles"
+            << "SweepCycles" << csv.endl;
+      }
+
+      csv << "LeakDetector" << dumpid << ld_round_count << ld_scanned_count
+          << ld_collected_count
+          << ld_phase_cycles[(size_t)LDPhase::PreScan]
+          << ld_phase_cycles[(size_t)LDPhase::Scan]
+          << ld_phase_cycles[(size_t)LDPhase::Sweep] << csv.endl;
+
+      if (dumpid == 0)
+      {
+        csv << "GCPauses"
+            << "DumpID";
+        for (size_t i = 0; i + 1 < GC_PAUSE_BUCKETS; i++)
+          csv << ("<2^" + std::to_string(i + GC_PAUSE_MIN_BITS));
+        csv << (">=2^" + std::to_string(GC_PAUSE_MAX_BITS)) << csv.endl;
+      }
+
+      csv << "GCPauses" << dumpid;
+      for (size_t i = 0; i < GC_PAUSE_BUCKETS; i++)
+        csv << gc_pause_count[i];
+      csv << csv.endl;
 #endif
     }
   };
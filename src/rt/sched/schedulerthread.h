@@ -10,6 +10,7 @@
 
 #include <snmalloc.h>
 #include <thread>
+#include <vector>
 
 namespace verona::rt
 {
@@ -17,6 +18,8 @@ namespace verona::rt
   class SchedulerThread
   {
   public:
+    using CownType = T;
+
     /// Friendly thread identifier for logging information.
     size_t systematic_id = 0;
     size_t systematic_speed_mask = 1;
@@ -38,6 +41,32 @@ namespace verona::rt
 
     static constexpr uint64_t TSC_QUIESCENCE_TIMEOUT = 1'000'000;
 
+    // How long a cown may wait in another thread's next-to-run slot before a
+    // thief may take it.
+    static constexpr uint64_t TSC_RUN_NEXT_STEAL = 10'000;
+
+    // How many cowns in a row may be taken from the next-to-run slot before
+    // we go back to the queue.
+    static constexpr size_t RUN_NEXT_LIMIT = 16;
+
+    // How long a thief looks for work on nearby threads before it is
+    // prepared to steal across NUMA nodes.
+    static constexpr uint64_t TSC_REMOTE_STEAL_BACKOFF =
+      TSC_QUIESCENCE_TIMEOUT / 8;
+
+    struct Victim
+    {
+      SchedulerThread<T>* thread;
+      Distance distance;
+    };
+
+    struct Muted
+    {
+      T* cown;
+      // Holds a weak reference.
+      T* target;
+    };
+
     T* token_cown = nullptr;
 
 #ifdef USE_SYSTEMATIC_TESTING
@@ -51,8 +80,44 @@ namespace verona::rt
     Alloc* alloc = nullptr;
     SchedulerThread<T>* next = nullptr;
     SchedulerThread<T>* victim = nullptr;
+
+    // The other threads in the pool, closest first. Set up by the thread pool
+    // before the threads are started.
+    std::vector<Victim> victims;
+    size_t victim_index = 0;
+
+    // A cown woken by a message from the running behaviour, to be run next
+    // on this thread, while the data the sender touched is still in cache.
+    std::atomic<T*> run_next = nullptr;
+    std::atomic<uint64_t> run_next_tsc = 0;
+    size_t run_next_streak = 0;
+
+    // A cown whose multimessage the running behaviour has fully acquired, to
+    // be run as soon as the running cown returns. Only used by this thread.
+    T* run_after = nullptr;
+    // Cowns run from `run_after` since we last picked a cown another way.
+    size_t inline_count = 0;
+
+    // The cown whose behaviours this thread is running, if any.
+    T* running_cown = nullptr;
+    // Set when the running behaviour sends to an overloaded cown.
+    T* mute_target = nullptr;
+    // Cowns held back until the cown they sent to catches up.
+    std::vector<Muted> muted;
     std::condition_variable cv;
 
+    // Where this thread waits when it is idle. Each thread has its own, so
+    // that waking one does not disturb the others.
+    std::mutex park_m;
+    std::condition_variable park_cv;
+    bool unparked = false;
+    SchedulerThread<T>* next_parked = nullptr;
+    // Whether we parked holding muted cowns. Protected by the pool's lock.
+    bool parked_muted = false;
+
+    // Position in the ring, used to decide whether we are retired.
+    size_t index = 0;
+
     bool running = true;
 
     // `n_ld_tokens` indicates the times of token cown a scheduler has to
@@ -77,11 +142,34 @@ namespace verona::rt
 
     std::thread t;
     ThreadState::State state = ThreadState::State::NotInLD;
+    // When we entered the current phase of the leak detector.
+    uint64_t ld_phase_tsc = 0;
     SchedulerStats stats;
 
+    // Cowns owned by this thread.
     T* list = nullptr;
     size_t total_cowns = 0;
-    std::atomic<size_t> free_cowns = 0;
+
+    // Owned cowns whose weak count has reached zero, pushed by the threads
+    // that released them.
+    std::atomic<T*> released_stubs = nullptr;
+
+    /**
+     * Released stubs taken by this thread, which wait until no thread that
+     * popped them from a queue can still be looking at them. They were
+     * popped in an epoch no later than the global epoch when they were
+     * taken, so a batch can be collected once that epoch is outdated.
+     **/
+    struct StubBatch
+    {
+      T* stubs;
+      uint64_t epoch;
+    };
+
+    // Only the batches of the last three global epochs can be waiting.
+    static constexpr size_t STUB_BATCHES = 4;
+    StubBatch stub_batches[STUB_BATCHES];
+    size_t stub_batch_count = 0;
 
     T* get_token_cown()
     {
@@ -112,8 +200,48 @@ namespace verona::rt
       running = false;
     }
 
+    /**
+     * Wait until another thread calls `unpark`. A call to `unpark` that comes
+     * first is not lost.
+     **/
+    void park()
+    {
+      std::unique_lock<std::mutex> lock(park_m);
+      while (!unparked)
+        park_cv.wait(lock);
+      unparked = false;
+    }
+
+    void unpark()
+    {
+      {
+        std::unique_lock<std::mutex> lock(park_m);
+        unparked = true;
+      }
+      park_cv.notify_one();
+    }
+
+    /**
+     * Whether we are beyond the pool's thread target. A retired thread runs
+     * what is already on its queue, but does not steal, and parks as soon as
+     * it runs out of work. Cowns it would reschedule are injected for an
+     * active thread to pick up, so that a busy cown cannot keep it running.
+     * It still takes part in the leak detector.
+     **/
+    bool is_retired()
+    {
+      return index >= Scheduler::get().thread_target.load(
+                        std::memory_order_relaxed);
+    }
+
     inline void schedule_fifo(T* a)
     {
+      if (is_retired())
+      {
+        Scheduler::inject(a);
+        return;
+      }
+
       Systematic::cout() << "Enqueued Cown: " << a << " ("
                          << a->get_epoch_mark() << ")" << std::endl;
 
@@ -134,6 +262,184 @@ namespace verona::rt
         stats.unpause();
     }
 
+    /**
+     * Add the cowns `first` to `last`, which are linked through
+     * `next_in_queue`, to the back of our queue. Returns how many there were.
+     **/
+    size_t schedule_batch(T* first, T* last)
+    {
+      size_t count = 0;
+      for (T* a = first;; a = a->next_in_queue)
+      {
+        Systematic::cout() << "Enqueued Cown: " << a << " ("
+                           << a->get_epoch_mark() << ")" << std::endl;
+        count++;
+
+        if (!a->scanned(send_epoch))
+        {
+          Systematic::cout() << "Enqueued Unscanned Cown: " << a << std::endl;
+          scheduled_unscanned_cown = true;
+        }
+
+        if (a == last)
+          break;
+      }
+
+      q.enqueue_batch(alloc, first, last);
+
+      // We have more work than we can run, so let others steal it from us.
+      if (Scheduler::get().unpause())
+        stats.unpause();
+
+      return count;
+    }
+
+    /**
+     * Move the cowns that threads outside the pool have scheduled onto our
+     * queue. Returns false if there were none, or we are retired.
+     **/
+    bool drain_injected()
+    {
+      if (is_retired())
+        return false;
+
+      T* last;
+      T* first = Scheduler::get().injected.dequeue_all(last);
+
+      if (first == nullptr)
+        return false;
+
+      stats.inject(schedule_batch(first, last));
+      return true;
+    }
+
+    /**
+     * Put `a`, which a message from the running behaviour has just woken, in
+     * the next-to-run slot. Any cown already there goes to the back of the
+     * queue.
+     **/
+    inline void schedule_next(T* a)
+    {
+      assert(!a->queue.is_sleeping());
+
+      // Keep the leak detector's view of the queue simple.
+      if ((state != ThreadState::NotInLD) || is_retired())
+      {
+        schedule_fifo(a);
+        return;
+      }
+
+      Systematic::cout() << "Next Scheduled Cown: " << a << " ("
+                         << a->get_epoch_mark() << ")" << std::endl;
+
+      if (!a->scanned(send_epoch))
+      {
+        Systematic::cout() << "Enqueued Unscanned Cown: " << a << std::endl;
+        scheduled_unscanned_cown = true;
+      }
+
+      run_next_tsc.store(Aal::tick(), std::memory_order_relaxed);
+      T* prev = run_next.exchange(a, std::memory_order_acq_rel);
+
+      if (prev != nullptr)
+      {
+        stats.lifo(false);
+        schedule_fifo(prev);
+      }
+      else if (Scheduler::get().unpause())
+      {
+        // Another thread may take it if we do not get to it soon.
+        stats.unpause();
+      }
+    }
+
+    /**
+     * Hand `a`, which has just been fully acquired by a multimessage sent from
+     * the running behaviour, to this thread to run as soon as that behaviour's
+     * cown returns. Returns false if the slot is taken, the thread has used up
+     * its budget for the current chain of hand-offs, or it is retired.
+     **/
+    bool schedule_after(T* a)
+    {
+      if (
+        (state != ThreadState::NotInLD) || (run_after != nullptr) ||
+        (inline_count >= Scheduler::get_inline_budget()) || is_retired())
+        return false;
+
+      Systematic::cout() << "Run after current: " << a << std::endl;
+
+      if (!a->scanned(send_epoch))
+      {
+        Systematic::cout() << "Enqueued Unscanned Cown: " << a << std::endl;
+        scheduled_unscanned_cown = true;
+      }
+
+      inline_count++;
+      stats.inline_run();
+      run_after = a;
+      return true;
+    }
+
+    T* take_run_after()
+    {
+      T* a = run_after;
+      run_after = nullptr;
+      return a;
+    }
+
+    /**
+     * Take the cown in our next-to-run slot, if there is one. After too many
+     * cowns in a row from the slot, it goes to the back of the queue instead,
+     * so that a pair of cowns messaging each other cannot starve the queue.
+     **/
+    T* take_run_next()
+    {
+      if (run_next.load(std::memory_order_relaxed) == nullptr)
+        return nullptr;
+
+      T* a = run_next.exchange(nullptr, std::memory_order_acquire);
+      if (a == nullptr)
+        return nullptr;
+
+      if (++run_next_streak > RUN_NEXT_LIMIT)
+      {
+        run_next_streak = 0;
+        stats.lifo(false);
+        schedule_fifo(a);
+        return nullptr;
+      }
+
+      Systematic::cout() << "Running next: " << a << std::endl;
+      stats.lifo(true);
+      return a;
+    }
+
+    /**
+     * Called by a thief on its victim. Takes the cown in the next-to-run slot
+     * if it has been waiting there for a while.
+     **/
+    T* steal_run_next()
+    {
+      T* a = run_next.load(std::memory_order_relaxed);
+      if (a == nullptr)
+        return nullptr;
+
+#ifdef USE_SYSTEMATIC_TESTING
+      if (!Scheduler::coin(2))
+        return nullptr;
+#else
+      uint64_t tsc = run_next_tsc.load(std::memory_order_relaxed);
+      if ((Aal::tick() - tsc) < TSC_RUN_NEXT_STEAL)
+        return nullptr;
+#endif
+
+      if (!run_next.compare_exchange_strong(
+            a, nullptr, std::memory_order_acquire, std::memory_order_relaxed))
+        return nullptr;
+
+      return a;
+    }
+
     inline void schedule_lifo(T* a)
     {
       // A lifo scheduled cown is coming from an external source, such as
@@ -141,7 +447,6 @@ namespace verona::rt
       Systematic::cout() << "LIFO Scheduled Cown: " << a << std::endl;
 
       q.enqueue_front(ThreadAlloc::get(), a);
-      stats.lifo();
 
       if (Scheduler::get().unpause())
         stats.unpause();
@@ -160,6 +465,10 @@ namespace verona::rt
         set_token_consumed(false);
         enqueue_token();
 
+        // Pick up external work once per pass through our queue, so that it
+        // is not starved while we are busy.
+        drain_injected();
+
         if (Scheduler::get().fair)
         {
           Systematic::cout() << "Should steal for fairness!" << std::endl;
@@ -178,7 +487,6 @@ namespace verona::rt
     void run(void (*startup)(Args...), Args... args)
     {
       startup(args...);
-      // TODO: back-pressure
       // Don't use affinity with systematic testing.  We're only ever running
       // one thread at a time in systematic testing mode and by pinning each
       // thread to a core we massively increase contention.
@@ -188,8 +496,11 @@ namespace verona::rt
 
       Scheduler::local() = this;
       alloc = ThreadAlloc::get();
-      victim = next;
+      victim_index = 0;
+      victim = victims.empty() ? this : victims[0].thread;
       T* cown = nullptr;
+      // Whether `cown` was handed to us by the previous behaviour.
+      bool handed_off = false;
 
 #ifdef USE_SYSTEMATIC_TESTING
       Scheduler::wait_for_my_first_turn();
@@ -198,7 +509,7 @@ namespace verona::rt
       while (true)
       {
         if (
-          (total_cowns < (free_cowns << 1))
+          stubs_to_collect()
 #ifdef USE_SYSTEMATIC_TESTING
           || Scheduler::coin()
 #endif
@@ -215,12 +526,27 @@ namespace verona::rt
         }
 
         check_token_cown();
+        check_ld_due();
+
+        unmute(state != ThreadState::NotInLD);
+
+        if (cown == nullptr)
+        {
+          cown = take_run_after();
+          handed_off = (cown != nullptr);
+        }
+
+        if (cown == nullptr)
+          cown = take_run_next();
 
         if (cown == nullptr)
         {
           cown = q.dequeue(alloc);
           if (cown != nullptr)
+          {
             Systematic::cout() << "Popped cown:" << cown << std::endl;
+            run_next_streak = 0;
+          }
         }
 
         if (cown == nullptr)
@@ -259,11 +585,23 @@ namespace verona::rt
 
         Systematic::cout() << "Running Cown: " << cown << std::endl;
 
+        // Long chains of hand-offs share one budget.
+        if (!handed_off)
+          inline_count = 0;
+        handed_off = false;
+
+        assert(mute_target == nullptr);
+        running_cown = cown;
         bool reschedule = cown->run(alloc, state, send_epoch);
+        running_cown = nullptr;
 
-        if (reschedule)
+        if (mute(cown, reschedule))
+        {
+          cown = nullptr;
+        }
+        else if (reschedule)
         {
-          if (should_steal_for_fairness)
+          if (should_steal_for_fairness || is_retired())
           {
             schedule_fifo(cown);
             cown = nullptr;
@@ -275,7 +613,18 @@ namespace verona::rt
             // otherwise run this cown again. Don't push to the queue
             // immediately to avoid another thread stealing our only cown.
 
-            T* n = q.dequeue(alloc);
+            T* n = take_run_after();
+            handed_off = (n != nullptr);
+
+            if (n == nullptr)
+              n = take_run_next();
+
+            if (n == nullptr)
+            {
+              n = q.dequeue(alloc);
+              if (n != nullptr)
+                run_next_streak = 0;
+            }
 
             if (n != nullptr)
             {
@@ -315,6 +664,9 @@ namespace verona::rt
 #endif
       }
 
+      assert(muted.empty());
+      assert(run_next.load() == nullptr);
+      assert(run_after == nullptr);
       Systematic::cout() << "Begin teardown (phase 1)" << std::endl;
 
       cown = list;
@@ -335,6 +687,7 @@ namespace verona::rt
       GlobalEpoch::advance();
 
       collect_cown_stubs();
+      collect_unreleased_cown_stubs();
 
       Systematic::cout() << "End teardown (phase 2)" << std::endl;
 
@@ -362,11 +715,126 @@ namespace verona::rt
       }
 
       // We were unable to steal, move to the next victim thread.
-      victim = victim->next;
+      next_victim(true);
+
+      return false;
+    }
+
+    /**
+     * Move on to the next victim. Victims are visited closest first, so after
+     * trying every victim we start again with our siblings. If `remote` is
+     * false, then victims on other NUMA nodes are skipped.
+     **/
+    void next_victim(bool remote)
+    {
+      if (victims.empty())
+        return;
+
+      victim_index++;
+      if (
+        (victim_index == victims.size()) ||
+        (!remote && (victims[victim_index].distance == Distance::Remote)))
+        victim_index = 0;
+
+      victim = victims[victim_index].thread;
+    }
+
+    /**
+     * Called when this thread sends to `target`, which is overloaded. Only
+     * sends from a running behaviour mute its cown. Others, such as those from
+     * finalisers run by the leak detector, have no cown to hold back.
+     **/
+    void sent_to_overloaded(T* target)
+    {
+      if ((running_cown == nullptr) || (mute_target != nullptr))
+        return;
+
+      target->weak_acquire();
+      mute_target = target;
+    }
+
+    /**
+     * Hold back `cown`, which has just run, if it sent to an overloaded cown.
+     * Returns true if `cown` has been muted, in which case we must not
+     * reschedule it.
+     *
+     * We never mute a cown that is itself overloaded, so that muted cowns
+     * only ever wait on cowns that are still making progress. Cowns are not
+     * held back during the leak detector, which expects to find them in a
+     * queue.
+     **/
+    bool mute(T* cown, bool reschedule)
+    {
+      T* target = mute_target;
+      if (target == nullptr)
+        return false;
+
+      mute_target = nullptr;
+
+      if (
+        !reschedule || (target == cown) || cown->is_overloaded() ||
+        (state != ThreadState::NotInLD))
+      {
+        target->weak_release(alloc);
+        return false;
+      }
+
+      Systematic::cout() << "Muting Cown: " << cown << " until " << target
+                         << " catches up" << std::endl;
+      muted.push_back({cown, target});
+      stats.mute();
+      Scheduler::record_mute();
+      return true;
+    }
 
+    /**
+     * Reschedule muted cowns whose receivers have caught up, or all of them
+     * if `all` is set.
+     **/
+    void unmute(bool all)
+    {
+      size_t i = 0;
+      while (i < muted.size())
+      {
+        Muted m = muted[i];
+
+        if (!all && m.target->is_overloaded())
+        {
+          i++;
+          continue;
+        }
+
+        Systematic::cout() << "Unmuting Cown: " << m.cown << std::endl;
+        muted[i] = muted.back();
+        muted.pop_back();
+        m.target->weak_release(alloc);
+        schedule_fifo(m.cown);
+      }
+    }
+
+    /**
+     * Whether the receiver of one of our muted cowns has caught up.
+     **/
+    bool muted_ready()
+    {
+      for (auto& m : muted)
+      {
+        if (!m.target->is_overloaded())
+          return true;
+      }
       return false;
     }
 
+    /**
+     * Start the leak detector if it has been asked for from outside the
+     * pool, or it is time for an automatic round.
+     **/
+    void check_ld_due()
+    {
+      if ((state == ThreadState::NotInLD) && Scheduler::get().ld_due())
+        want_ld();
+    }
+
     void dec_n_ld_tokens()
     {
       assert(n_ld_tokens == 1 || n_ld_tokens == 2);
@@ -401,6 +869,7 @@ namespace verona::rt
       while (running)
       {
         check_token_cown();
+        check_ld_due();
 
         yield();
 
@@ -412,34 +881,93 @@ namespace verona::rt
         // Participate in the cown LD protocol.
         ld_protocol();
 
+        // Muted cowns wait for their receivers, even if we have nothing else
+        // to do. Letting them go when idle would undo the back-pressure
+        // whenever the receiver runs on another thread.
+        if (!muted.empty())
+          unmute(state != ThreadState::NotInLD);
+
         // Check if some other thread has pushed work on our queue.
         cown = q.dequeue(alloc);
 
         if (cown != nullptr)
           return cown;
 
+        // Prefer work from outside the pool to stealing.
+        if (drain_injected())
+          continue;
+
+        // Only steal across NUMA nodes once we have failed to find work
+        // closer to home for a while.
+#ifdef USE_SYSTEMATIC_TESTING
+        bool remote = Scheduler::coin(1);
+#else
+        bool remote = (Aal::tick() - tsc) >= TSC_REMOTE_STEAL_BACKOFF;
+#endif
+        Distance distance = victims.empty() ?
+          Distance::Sibling :
+          victims[victim_index].distance;
+
         // Try to steal from the victim thread.
-        if (victim != this)
+        bool retired = is_retired();
+        if (
+          (victim != this) && !retired &&
+          (remote || distance != Distance::Remote))
         {
-          cown = victim->q.dequeue(alloc);
+          // Take up to half of the victim's queue, so that a thread that has
+          // fanned out lots of work is drained quickly.
+          T* rest;
+          T* last;
+          cown = victim->q.dequeue_batch(
+            alloc, rest, last, Scheduler::get().steal_batch);
 
           if (cown != nullptr)
           {
-            stats.steal();
+            stats.steal(distance);
             Systematic::cout() << "Stole Cown: " << cown << " from "
                                << victim->systematic_id << std::endl;
+
+            if (rest != nullptr)
+              schedule_batch(rest, last);
+
+            return cown;
+          }
+
+          // The victim's queue is empty, but it may have left a cown in its
+          // next-to-run slot for too long.
+          cown = victim->steal_run_next();
+
+          if (cown != nullptr)
+          {
+            stats.lifo(false);
+            Systematic::cout() << "Stole next Cown: " << cown << " from "
+                               << victim->systematic_id << std::endl;
             return cown;
           }
         }
 
         // We were unable to steal, move to the next victim thread.
-        victim = victim->next;
+        next_victim(remote);
+
+        // Help with a freeze that a behaviour is waiting for.
+        if (!retired && FreezeTasks::run_one(alloc))
+        {
+          stats.freeze_task();
+          continue;
+        }
+
+        // Help release large object graphs before going to sleep.
+        if (!retired && DeferredRelease::run_one(alloc))
+        {
+          stats.deferred_release();
+          continue;
+        }
 
         // Wait until a minimum timeout has passed.
         uint64_t tsc2 = Aal::tick();
 
 #ifndef USE_SYSTEMATIC_TESTING
-        if ((tsc2 - tsc) < TSC_QUIESCENCE_TIMEOUT)
+        if (((tsc2 - tsc) < Scheduler::get_park_spin()) && !retired)
         {
           Aal::pause();
         }
@@ -450,7 +978,11 @@ namespace verona::rt
         }
 #endif
           // Enter sleep only when the queue doesn't contain any real cowns.
-          if (state == ThreadState::NotInLD && q.is_empty())
+          // Muted cowns do not keep us awake, as `capacity_available` wakes
+          // us when one of their receivers catches up.
+          if (
+            state == ThreadState::NotInLD && q.is_empty() &&
+            (run_next.load(std::memory_order_relaxed) == nullptr))
         {
           // We've been spinning looking for work for some time. While paused,
           // our running flag may be set to false, in which case we terminate.
@@ -516,10 +1048,7 @@ namespace verona::rt
       {
         Systematic::cout() << "Bind cown " << this << " to scheduler thread."
                            << std::endl;
-        cown->set_owning_thread(this);
-        cown->next = list;
-        list = cown;
-        total_cowns++;
+        add_cown(cown);
       }
 
       return true;
@@ -560,7 +1089,11 @@ namespace verona::rt
         Systematic::cout() << "Scheduler unscanned flag: "
                            << scheduled_unscanned_cown << std::endl;
 
-        if (!scheduled_unscanned_cown && Scheduler::no_inflight_messages())
+        // Graphs waiting to be released may still hold references to cowns
+        // that were not reachable when they were scanned.
+        if (
+          !scheduled_unscanned_cown && Scheduler::no_inflight_messages() &&
+          DeferredRelease::is_idle())
         {
           ld_state_change(ThreadState::BelieveDone_Vote);
         }
@@ -584,7 +1117,7 @@ namespace verona::rt
         // trying to perform a LD.
         if (
           sprev == ThreadState::PreScan && snext == ThreadState::PreScan &&
-          Scheduler::get().unpause())
+          Scheduler::get().unpause_all())
         {
           stats.unpause();
         }
@@ -606,7 +1139,7 @@ namespace verona::rt
         {
           case ThreadState::PreScan:
           {
-            if (Scheduler::get().unpause())
+            if (Scheduler::get().unpause_all())
               stats.unpause();
 
             enter_prescan();
@@ -665,6 +1198,16 @@ namespace verona::rt
     {
       Systematic::cout() << "Scheduler state change: " << state << " -> "
                          << snext << std::endl;
+
+      LDPhase from = ThreadState::phase(state);
+      if (from != ThreadState::phase(snext))
+      {
+        uint64_t now = Aal::tick();
+        if (from != LDPhase::None)
+          stats.ld_phase(from, now - ld_phase_tsc);
+        ld_phase_tsc = now;
+      }
+
       state = snext;
     }
 
@@ -713,15 +1256,109 @@ namespace verona::rt
     void collect_cowns()
     {
       T* p = list;
+      size_t collected = 0;
 
       while (p != nullptr)
       {
         T* n = p->next;
-        p->try_collect(alloc, send_epoch);
+        // Stubs of cowns that were already collected do not count.
+        bool was_collected = p->is_collected();
+        if (p->try_collect(alloc, send_epoch) && !was_collected)
+          collected++;
         p = n;
       }
+
+      stats.ld_collected(collected);
+      if (Scheduler::get().ld_round_swept(collected))
+        stats.ld_round();
+    }
+
+    /**
+     * Add `cown` to the cowns owned by this thread.
+     **/
+    void add_cown(T* cown)
+    {
+      cown->set_owning_thread(this);
+      cown->prev = nullptr;
+      cown->next = list;
+      if (list != nullptr)
+        list->prev = cown;
+      list = cown;
+      total_cowns++;
+    }
+
+    void remove_cown(T* cown)
+    {
+      if (cown->prev == nullptr)
+        list = cown->next;
+      else
+        cown->prev->next = cown->next;
+
+      if (cown->next != nullptr)
+        cown->next->prev = cown->prev;
+
+      total_cowns--;
+    }
+
+    /**
+     * Called by any thread once the weak count of `cown`, which this thread
+     * owns, has reached zero, so that this thread collects its stub.
+     **/
+    void release_stub(T* cown)
+    {
+      T* head = released_stubs.load(std::memory_order_relaxed);
+      do
+      {
+        cown->next_stub = head;
+      } while (!released_stubs.compare_exchange_weak(
+        head, cown, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Whether some stubs have been released, or the oldest waiting batch of
+     * stubs can be collected.
+     **/
+    bool stubs_to_collect()
+    {
+      return (released_stubs.load(std::memory_order_relaxed) != nullptr) ||
+        ((stub_batch_count > 0) &&
+         GlobalEpoch::is_outdated(stub_batches[0].epoch));
+    }
+
+    /**
+     * Add the list of `stubs` to the batch of the current global epoch.
+     **/
+    void wait_for_epoch(T* stubs)
+    {
+      T* last = stubs;
+      while (last->next_stub != nullptr)
+        last = last->next_stub;
+
+      uint64_t epoch = GlobalEpoch::get();
+
+      if (stub_batch_count > 0)
+      {
+        // Joining a batch from an earlier epoch only makes its stubs wait
+        // longer, so do that if there is no room left.
+        StubBatch& newest = stub_batches[stub_batch_count - 1];
+        if ((newest.epoch == epoch) || (stub_batch_count == STUB_BATCHES))
+        {
+          last->next_stub = newest.stubs;
+          newest.stubs = stubs;
+          newest.epoch = epoch;
+          return;
+        }
+      }
+
+      last->next_stub = nullptr;
+      stub_batches[stub_batch_count++] = {stubs, epoch};
     }
 
+    /**
+     * Collect the stubs of the cowns whose weak count has reached zero.
+     * Each stub is looked at when it is released and when its batch is
+     * collected, rather than walking every cown this thread owns.
+     **/
     void collect_cown_stubs()
     {
       // Cannot collect the cown state while another thread could be
@@ -737,40 +1374,105 @@ namespace verona::rt
         default:;
       }
 
-      T** p = &list;
+      if (!stubs_to_collect())
+        return;
+
       size_t count = 0;
 
-      while (*p != nullptr)
+      // Stubs that were never popped from a queue can go straight away.
+      T* c = released_stubs.exchange(nullptr, std::memory_order_acquire);
+      T* waiting = collect_outdated(c, count);
+
+      while (
+        (stub_batch_count > 0) &&
+        GlobalEpoch::is_outdated(stub_batches[0].epoch))
       {
-        T* c = *p;
-        // Collect cown stubs when the weak count is zero.
-        if (c->weak_count == 0)
+        // Every stub in the batch was popped no later than the batch's
+        // epoch, which is outdated, so none can be left.
+        T* left = collect_outdated(stub_batches[0].stubs, count);
+        assert(left == nullptr);
+        UNUSED(left);
+
+        stub_batch_count--;
+        for (size_t i = 0; i < stub_batch_count; i++)
+          stub_batches[i] = stub_batches[i + 1];
+      }
+
+      if (waiting != nullptr)
+        wait_for_epoch(waiting);
+
+      stats.cown_stubs(count);
+    }
+
+    /**
+     * Collect the stubs in the list `c` that no thread can still be looking
+     * at, adding them to `count`. Returns the list of those left.
+     **/
+    T* collect_outdated(T* c, size_t& count)
+    {
+      T* left = nullptr;
+
+      while (c != nullptr)
+      {
+        T* n = c->next_stub;
+        assert(c->weak_count == 0);
+        Systematic::cout() << "Stub collect: " << c << std::endl;
+
+        auto epoch = c->epoch_when_popped;
+        if (epoch == T::NO_EPOCH_SET || GlobalEpoch::is_outdated(epoch))
         {
-          Systematic::cout() << "Stub collect: " << c << std::endl;
-          // TODO: Investigate systematic testing coverage here.
-          auto epoch = c->epoch_when_popped;
-          auto outdated =
-            epoch == T::NO_EPOCH_SET || GlobalEpoch::is_outdated(epoch);
-          if (outdated)
-          {
-            count++;
-            *p = c->next;
-            assert((!Scheduler::get_detect_leaks()) || c->cown_zero_rc());
-            c->dealloc(alloc);
-            Systematic::cout() << "Stub collected: " << c << std::endl;
-            continue;
-          }
-          else
-          {
-            if (!outdated)
-              Systematic::cout()
-                << "Cown " << c << " not outdated." << std::endl;
-          }
+          count++;
+          remove_cown(c);
+          assert((!Scheduler::get_detect_leaks()) || c->cown_zero_rc());
+          c->dealloc(alloc);
+          Systematic::cout() << "Stub collected: " << c << std::endl;
+        }
+        else
+        {
+          Systematic::cout() << "Cown " << c << " not outdated." << std::endl;
+          c->next_stub = left;
+          left = c;
+        }
+
+        c = n;
+      }
+
+      return left;
+    }
+
+    /**
+     * Collect the stubs of every cown whose weak count has reached zero
+     * during teardown, when weak counts are dropped without telling the
+     * owning thread. This walks every cown this thread owns.
+     **/
+    void collect_unreleased_cown_stubs()
+    {
+      T* c = list;
+      size_t count = 0;
+
+      while (c != nullptr)
+      {
+        T* n = c->next;
+        auto epoch = c->epoch_when_popped;
+        if (
+          (c->weak_count == 0) &&
+          (epoch == T::NO_EPOCH_SET || GlobalEpoch::is_outdated(epoch)))
+        {
+          count++;
+          remove_cown(c);
+          assert((!Scheduler::get_detect_leaks()) || c->cown_zero_rc());
+          c->dealloc(alloc);
+          Systematic::cout() << "Stub collected: " << c << std::endl;
         }
-        p = &(c->next);
+        c = n;
       }
 
-      free_cowns -= count;
+      // Every released or waiting stub is also in the list of cowns, so has
+      // been dealt with above. No other thread releases stubs to us after the
+      // teardown barrier.
+      released_stubs.store(nullptr, std::memory_order_relaxed);
+      stub_batch_count = 0;
+      stats.cown_stubs(count);
     }
   };
 } // namespace verona::rt
@@ -103,6 +103,89 @@ namespace verona::rt
       } while (!cmp.store_conditional(node));
     }
 
+    /**
+     * Add the elements `first` to `last`, which are already linked through
+     * `next_in_queue`, to the back of the queue in one go.
+     **/
+    void enqueue_batch(Alloc* alloc, T* first, T* last)
+    {
+      UNUSED(alloc);
+      auto unmasked_last = unmask(last);
+      unmasked_last->next_in_queue = nullptr;
+      auto unmasked_back = unmask(back);
+      unmasked_back->next_in_queue.store(first, std::memory_order_release);
+      back = last;
+    }
+
+    /**
+     * Dequeue up to half of the elements in the queue, and at most `max`,
+     * with a single update of `front`. Returns the first element, and sets
+     * `rest` and `last` to the second and final ones, or `rest` to null if
+     * there is only one. The rest are still linked through `next_in_queue`,
+     * and are expected to go straight onto another queue.
+     *
+     * A token is only ever returned on its own, so that tokens are not moved
+     * into the queue of another thread.
+     **/
+    T* dequeue_batch(Alloc* alloc, T*& rest, T*& last, size_t max)
+    {
+      T* next;
+      T* fnt;
+
+      // Hold epoch to ensure that the elements reachable from `front` cannot
+      // be deallocated during this operation.  This must occur before read of
+      // front.
+      Epoch e(alloc);
+      uint64_t epoch = e.get_local_epoch_epoch();
+
+      auto cmp = front.read();
+      do
+      {
+        fnt = cmp.ptr();
+        last = fnt;
+        // This operation is memory safe due to holding the epoch.
+        next = unmask(fnt)->next_in_queue;
+
+        if (next == nullptr)
+          return nullptr;
+
+        // `probe` moves two elements for every one added to the batch, so
+        // the batch is at most half of the queue.
+        //
+        // Other threads may pop the elements we are walking. A popped element
+        // keeps its last link, which points at an element that was queued
+        // while we held the epoch, so every step is memory safe, even if it
+        // is stale. As elements only leave the queue through `front`, the ABA
+        // protected update of `front` then fails unless every link we
+        // followed was still in the queue.
+        T* probe = next;
+        size_t count = 1;
+        while ((count < max) && !is_bit_set(last) && !is_bit_set(next))
+        {
+          probe = unmask(probe)->next_in_queue;
+          if (probe == nullptr)
+            break;
+
+          probe = unmask(probe)->next_in_queue;
+          if (probe == nullptr)
+            break;
+
+          last = next;
+          next = unmask(next)->next_in_queue;
+          count++;
+        }
+      } while (!cmp.store_conditional(next));
+
+      assert(epoch != T::NO_EPOCH_SET);
+
+      // Only the first element is marked as popped, as the rest go straight
+      // onto another queue.
+      rest = (last == fnt) ? nullptr : fnt->next_in_queue.load();
+      fnt->epoch_when_popped = epoch;
+
+      return fnt;
+    }
+
     T* dequeue(Alloc* alloc)
     {
       T* next;
@@ -2,12 +2,18 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include "../region/deferred_release.h"
+#include "../region/freeze_tasks.h"
 #include "cpu.h"
+#include "injectqueue.h"
 #include "threadstate.h"
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <snmalloc.h>
+#include <vector>
 
 #ifdef USE_SYSTEMATIC_TESTING
 #  include "ds/scramble.h"
@@ -26,10 +32,25 @@ namespace verona::rt
   private:
     friend T;
 
-    static constexpr uint64_t TSC_PAUSE_SLOP = 1'000'000;
-    static constexpr uint64_t TSC_UNPAUSE_SLOP = TSC_PAUSE_SLOP / 2;
-
     bool detect_leaks = true;
+
+    /// Whether the scheduler threads start leak detector rounds themselves,
+    /// rather than only when `want_ld` is called.
+    bool auto_ld = false;
+    /// Cycles from the end of one automatic round to the start of the next
+    /// while rounds keep collecting cowns. Each round that collects nothing
+    /// doubles the interval, up to `ld_max_interval`.
+    uint64_t ld_min_interval = 1'000'000'000;
+    uint64_t ld_max_interval = 64'000'000'000;
+    std::atomic<uint64_t> ld_interval = 1'000'000'000;
+    std::atomic<uint64_t> last_ld_tsc = 0;
+    /// Set by `want_ld` outside the pool, for a scheduler thread to act on.
+    std::atomic<bool> ld_requested = false;
+    /// Threads that have swept in the current round, and the cowns they
+    /// collected between them.
+    std::atomic<size_t> ld_swept = 0;
+    std::atomic<size_t> ld_collected = 0;
+    std::atomic<size_t> ld_rounds = 0;
     size_t incarnation = 1;
     size_t thread_count = 0;
     size_t active_thread_count = 0;
@@ -45,12 +66,44 @@ namespace verona::rt
     std::condition_variable cv;
     std::atomic_uint64_t barrier_count = 0;
     T* first_thread = nullptr;
+
+    /// Idle threads, each waiting on its own parking spot. Protected by `m`.
+    T* parked = nullptr;
+    std::atomic<size_t> parked_count = 0;
+    /// Parked threads that are holding muted cowns.
+    std::atomic<size_t> muted_parked = 0;
+    /// The last active thread, if it has parked while teardown is disallowed.
+    T* runtime_parked = nullptr;
+
+    /// Cycles a thread spends looking for work before it parks. Work that is
+    /// scheduled within half this time of a thread being woken does not wake
+    /// another.
+    uint64_t park_spin = 1'000'000;
+
+    /// Threads at or beyond this position in the ring are retired: they finish
+    /// their own work and then park until the target grows again or the leak
+    /// detector needs them. Protected by `m`, but read without it.
+    std::atomic<size_t> thread_target = 0;
+    /// The most threads that may be active, as set by `set_thread_target`.
+    /// Zero means all of them.
+    size_t thread_limit = 0;
+    /// Whether the target follows the load, up to `thread_limit`.
+    bool adaptive_threads = false;
 #ifdef USE_SYSTEMATIC_TESTING
     T* running_thread = nullptr;
     xoroshiro::p128r32 r;
     Scramble scrambler;
 #endif
 
+    /// Set while the scheduler threads are running.
+    std::atomic<bool> running = false;
+
+    /// Cowns scheduled by threads outside the pool.
+    InjectQueue<typename T::CownType> injected;
+    /// Whether threads outside the pool use `injected`, rather than placing
+    /// cowns on the scheduler threads' queues in turn.
+    bool inject_external = true;
+
     bool allow_teardown = true;
     // Pausing if value is odd.
     // Is not atomic, since updates are only made while a lock is held.
@@ -60,6 +113,32 @@ namespace verona::rt
 
     bool fair = false;
 
+    /// The most cowns a thread takes from another in one steal.
+    size_t steal_batch = 32;
+
+    /// Whether senders are slowed down when their receivers fall behind.
+    bool back_pressure = false;
+    /// The longest an external thread waits for an overloaded cown it sends
+    /// to, in microseconds.
+    uint64_t external_wait = 10'000;
+    /// External threads waiting for an overloaded cown to catch up.
+    std::mutex back_pressure_m;
+    std::condition_variable back_pressure_cv;
+    std::atomic<size_t> back_pressure_waiters = 0;
+    /// Cowns muted, and external sends that waited, since `init`.
+    std::atomic<size_t> muted_count = 0;
+    std::atomic<size_t> external_wait_count = 0;
+
+    /// Fully acquired multimessages a thread may run straight after the
+    /// behaviour that sent them, in one chain. Off by default.
+    size_t inline_budget = 0;
+
+    /// Cycles a cown spends processing messages before it is rescheduled,
+    /// unless its descriptor says otherwise.
+    uint64_t batch_budget = 100'000;
+
+    Placement placement = Placement::Compact;
+
     ThreadState state;
     Topology topology;
 
@@ -80,11 +159,57 @@ namespace verona::rt
       return get().detect_leaks;
     }
 
+    /**
+     * Have the scheduler threads run the leak detector every `min_interval`
+     * cycles while it keeps finding cycles of cowns, backing off to every
+     * `max_interval` cycles while it does not. Without this, which suits
+     * workloads that do not create cycles, it only runs when asked to with
+     * `want_ld`, and at teardown.
+     **/
+    static void set_ld_pacing(
+      bool automatic,
+      uint64_t min_interval = 1'000'000'000,
+      uint64_t max_interval = 64'000'000'000)
+    {
+      auto& pool = get();
+      pool.auto_ld = automatic;
+      pool.ld_min_interval = min_interval;
+      pool.ld_max_interval = std::max(min_interval, max_interval);
+      pool.ld_interval = min_interval;
+    }
+
+    static bool get_ld_pacing()
+    {
+      return get().auto_ld;
+    }
+
+    /**
+     * The number of leak detector rounds completed since `init`.
+     **/
+    static size_t get_ld_rounds()
+    {
+      return get().ld_rounds;
+    }
+
+    /**
+     * Cycles until the next automatic leak detector round may start, once
+     * the current one has finished.
+     **/
+    static uint64_t get_ld_interval()
+    {
+      return get().ld_interval;
+    }
+
     static void record_inflight_message()
     {
       Systematic::cout() << "Increase inflight count: "
                          << get().inflight_count + 1 << std::endl;
-      local()->scheduled_unscanned_cown = true;
+
+      // Messages from outside the pool are only counted.
+      T* t = local();
+      if (t != nullptr)
+        t->scheduled_unscanned_cown = true;
+
       get().inflight_count++;
     }
 
@@ -111,6 +236,16 @@ namespace verona::rt
         s.unpause();
     }
 
+    /**
+     * Wake an idle thread, if there is one, to pick up work that was not put
+     * in a scheduler queue, such as graphs left by DeferredRelease, or parts
+     * of a freeze left in FreezeTasks.
+     **/
+    static void wake_idle_thread()
+    {
+      get().unpause();
+    }
+
     static void set_fair(bool fair)
     {
       Systematic::cout() << "Set fair: " << fair << std::endl;
@@ -118,6 +253,231 @@ namespace verona::rt
       s.fair = fair;
     }
 
+    /**
+     * Set the most cowns an idle thread takes from another in one steal. A
+     * thief never takes more than half of the victim's queue.
+     **/
+    static void set_steal_batch(size_t steal_batch)
+    {
+      Systematic::cout() << "Set steal batch: " << steal_batch << std::endl;
+      assert(steal_batch > 0);
+      get().steal_batch = steal_batch;
+    }
+
+    /**
+     * Enable or disable back-pressure. When enabled, a cown that cannot work
+     * through its message queue in one batch is marked as overloaded. Cowns
+     * that send to it are then held back until it catches up. External
+     * threads that send to it block until it catches up, for at most
+     * `external_wait` microseconds per send. An `external_wait` of zero lets
+     * external threads send without waiting.
+     **/
+    static void
+    set_back_pressure(bool back_pressure, uint64_t external_wait = 10'000)
+    {
+      Systematic::cout() << "Set back pressure: " << back_pressure << " "
+                         << external_wait << std::endl;
+      get().back_pressure = back_pressure;
+      get().external_wait = external_wait;
+    }
+
+    static bool get_back_pressure()
+    {
+      return get().back_pressure;
+    }
+
+    /**
+     * The number of times a cown has been held back because it sent to an
+     * overloaded cown, since `init`.
+     **/
+    static size_t get_muted_count()
+    {
+      return get().muted_count;
+    }
+
+    /**
+     * The number of sends from external threads that waited for an
+     * overloaded cown, since `init`.
+     **/
+    static size_t get_external_wait_count()
+    {
+      return get().external_wait_count;
+    }
+
+    static void record_mute()
+    {
+      get().muted_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Block the calling external thread until `caught_up` holds, for at most
+     * `external_wait` microseconds. A missed wake-up only costs the timeout.
+     **/
+    template<typename F>
+    static void wait_for_capacity(F caught_up)
+    {
+      auto& pool = get();
+      if (pool.external_wait == 0)
+        return;
+
+      pool.external_wait_count.fetch_add(1, std::memory_order_relaxed);
+
+      std::unique_lock<std::mutex> lock(pool.back_pressure_m);
+      pool.back_pressure_waiters++;
+      pool.back_pressure_cv.wait_for(
+        lock, std::chrono::microseconds(pool.external_wait), [&]() {
+          return caught_up() || pool.teardown_in_progress;
+        });
+      pool.back_pressure_waiters--;
+    }
+
+    /**
+     * Called when an overloaded cown catches up, to wake any threads parked
+     * with muted cowns, and any external threads waiting in
+     * `wait_for_capacity`.
+     **/
+    static void capacity_available()
+    {
+      auto& pool = get();
+
+      // Pairs with the barrier in `pause`: either we see the parked thread,
+      // or it sees that the receiver has caught up.
+      Barrier::memory();
+      if (pool.muted_parked.load(std::memory_order_relaxed) != 0)
+        pool.unpark_muted();
+
+      if (pool.back_pressure_waiters.load() == 0)
+        return;
+
+      {
+        std::unique_lock<std::mutex> lock(pool.back_pressure_m);
+      }
+      pool.back_pressure_cv.notify_all();
+    }
+
+    /**
+     * Set how many multimessages a scheduler thread may run as soon as the
+     * behaviour that acquired their last cown returns, ahead of its queue,
+     * before it goes back to its queue. Zero, the default, disables this.
+     **/
+    static void set_inline_budget(size_t inline_budget)
+    {
+      Systematic::cout() << "Set inline budget: " << inline_budget
+                         << std::endl;
+      get().inline_budget = inline_budget;
+    }
+
+    static size_t get_inline_budget()
+    {
+      return get().inline_budget;
+    }
+
+    /**
+     * Set the number of cycles a cown may spend processing messages before it
+     * yields to the scheduler. Cown types can override this with a static
+     * `batch_budget` member.
+     **/
+    static void set_batch_budget(uint64_t batch_budget)
+    {
+      Systematic::cout() << "Set batch budget: " << batch_budget << std::endl;
+      assert(batch_budget > 0);
+      get().batch_budget = batch_budget;
+    }
+
+    static uint64_t get_batch_budget()
+    {
+      return get().batch_budget;
+    }
+
+    /**
+     * Choose how threads outside the pool schedule cowns: through a shared
+     * injection queue that scheduler threads drain in batches, or by pushing
+     * onto the front of each scheduler thread's queue in turn.
+     **/
+    static void set_inject_external(bool inject_external)
+    {
+      Systematic::cout() << "Set inject external: " << inject_external
+                         << std::endl;
+      get().inject_external = inject_external;
+    }
+
+    static bool get_inject_external()
+    {
+      return get().inject_external;
+    }
+
+    /**
+     * Hand a cown that needs running to the scheduler, from a thread outside
+     * the pool.
+     **/
+    static void inject(typename T::CownType* cown)
+    {
+      Systematic::cout() << "Injected Cown: " << cown << std::endl;
+      auto& s = get();
+      s.injected.enqueue(cown);
+      s.unpause();
+    }
+
+    /**
+     * Set how scheduler threads are pinned to CPUs. Takes effect the next time
+     * the runtime is started.
+     **/
+    static void set_placement(Placement placement)
+    {
+      Systematic::cout() << "Set placement: " << (int)placement << std::endl;
+      get().placement = placement;
+    }
+
+    /**
+     * Set how many cycles an idle thread spins looking for work before it
+     * parks. Lower values use less CPU when load is light, at the cost of
+     * slower wakeups when work arrives.
+     **/
+    static void set_park_spin(uint64_t park_spin)
+    {
+      Systematic::cout() << "Set park spin: " << park_spin << std::endl;
+      get().park_spin = park_spin;
+    }
+
+    static uint64_t get_park_spin()
+    {
+      return get().park_spin;
+    }
+
+    /**
+     * Set how many scheduler threads take part in running cowns. Threads
+     * beyond the target finish the work they have and then park, so the pool
+     * can give up CPUs to other processes without being restarted. Zero means
+     * all threads. May be called before or while the runtime is running.
+     **/
+    static void set_thread_target(size_t target)
+    {
+      Systematic::cout() << "Set thread target: " << target << std::endl;
+      auto& s = get();
+      std::unique_lock<std::mutex> lock(s.m);
+      s.thread_limit = target;
+      if (s.thread_count != 0)
+        s.thread_target = s.max_threads();
+    }
+
+    static size_t get_thread_target()
+    {
+      return get().thread_target;
+    }
+
+    /**
+     * When enabled, the thread target shrinks by one each time an active
+     * thread runs out of work and parks, and grows by one, up to the limit
+     * set by `set_thread_target`, when work is scheduled and no active thread
+     * is parked to take it. Work is then packed onto the first threads in the
+     * ring.
+     **/
+    static void set_adaptive_threads(bool adaptive)
+    {
+      Systematic::cout() << "Set adaptive threads: " << adaptive << std::endl;
+      get().adaptive_threads = adaptive;
+    }
+
     static bool is_teardown_in_progress()
     {
       return get().teardown_in_progress;
@@ -232,17 +592,10 @@ namespace verona::rt
       sched.wait_for_my_turn_inner(me);
     }
 
-    /// Used to simulate waking all waiting threads on the thread pools
-    /// condition variable.
-    static void cv_notify_all()
+    /// Used to simulate waking a parked thread.
+    static void cv_notify_one(T* t)
     {
-      auto head = get().first_thread;
-      auto curr = head;
-      do
-      {
-        curr->sleeping = false;
-        curr = curr->next;
-      } while (curr != head);
+      t->sleeping = false;
 
       // Can be signalled from outside the runtime if external work is injected
       // if this is a runtime thread, then yield.
@@ -279,6 +632,20 @@ namespace verona::rt
       return EpochMark::EPOCH_A;
     }
 
+    /**
+     * The epoch of a message sent from outside the pool. Before the runtime
+     * starts, any epoch will do. Once it is running we cannot tell how far
+     * the leak detector has got, so the message must be counted as inflight:
+     * the leak detector then waits for it, and scans it if necessary.
+     **/
+    static EpochMark external_epoch()
+    {
+      if (get().running.load(std::memory_order_acquire))
+        return EpochMark::EPOCH_NONE;
+
+      return EpochMark::EPOCH_A;
+    }
+
     static EpochMark alloc_epoch()
     {
       T* t = local();
@@ -346,12 +713,23 @@ namespace verona::rt
         ((get().state.get_state()) == ThreadState::PreScan);
     }
 
+    /**
+     * Start a leak detector round, if one is not already running. This can
+     * be called from outside the pool, in which case the next scheduler
+     * thread to look for work starts it.
+     **/
     static void want_ld()
     {
       T* t = local();
 
       if (t != nullptr)
+      {
         t->want_ld();
+        return;
+      }
+
+      get().ld_requested.store(true, std::memory_order_release);
+      get().unpause();
     }
 
     void init(size_t count)
@@ -359,6 +737,14 @@ namespace verona::rt
       if ((thread_count != 0) || (count == 0))
         abort();
 
+      ld_swept = 0;
+      ld_collected = 0;
+      ld_rounds = 0;
+      ld_interval = ld_min_interval;
+      muted_count = 0;
+      external_wait_count = 0;
+      last_ld_tsc = Aal::tick();
+
       // Build a circular linked list of scheduler threads.
       thread_count = count;
       first_thread = new T;
@@ -391,8 +777,13 @@ namespace verona::rt
     template<typename... Args>
     void run_with_startup(void (*startup)(Args...), Args... args)
     {
-      topology.acquire();
+      topology.acquire(placement);
+      init_victims();
       active_thread_count = thread_count;
+      thread_target = max_threads();
+      running.store(true, std::memory_order_release);
+      DeferredRelease::set_accepting(true);
+      FreezeTasks::set_accepting(true);
 
       init_barrier();
 #ifdef USE_SYSTEMATIC_TESTING
@@ -406,6 +797,7 @@ namespace verona::rt
 
       do
       {
+        t->index = i;
         t->template start<Args...>(topology.get(i++), startup, args...);
         t = t->next;
       } while (t != first_thread);
@@ -419,6 +811,9 @@ namespace verona::rt
         t = next;
       } while (t != first_thread);
       Systematic::cout() << "All threads stopped" << std::endl;
+      running.store(false, std::memory_order_release);
+      assert(injected.is_empty());
+      assert(parked == nullptr);
 
       first_thread = nullptr;
       incarnation++;
@@ -427,6 +822,8 @@ namespace verona::rt
 #endif
       thread_count = 0;
       active_thread_count = 0;
+      thread_target = 0;
+      ld_requested = false;
       state.reset<ThreadState::NotInLD>();
       topology.release();
 
@@ -438,35 +835,166 @@ namespace verona::rt
       return get().active_thread_count == 0;
     }
 
+    /**
+     * Whether the calling scheduler thread is beyond the thread target.
+     **/
+    static bool debug_is_retired()
+    {
+      T* t = local();
+      return (t != nullptr) && t->is_retired();
+    }
+
   private:
     inline ThreadState::State next_state(ThreadState::State s)
     {
       return state.next(s, thread_count);
     }
 
+    /**
+     * Whether a scheduler thread should start a leak detector round, either
+     * because one was asked for from outside the pool, or because it is
+     * time for an automatic one.
+     **/
+    bool ld_due()
+    {
+      if (
+        ld_requested.load(std::memory_order_relaxed) &&
+        ld_requested.exchange(false, std::memory_order_acquire))
+        return true;
+
+      if (!auto_ld || (state.get_state() != ThreadState::NotInLD))
+        return false;
+
+      return (Aal::tick() - last_ld_tsc.load(std::memory_order_relaxed)) >=
+        ld_interval.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * A scheduler thread has swept, and collected `collected` cowns. Returns
+     * true if it was the last to do so in this round, in which case the
+     * interval to the next automatic round is set from what the round found.
+     **/
+    bool ld_round_swept(size_t collected)
+    {
+      ld_collected += collected;
+
+      if ((ld_swept.fetch_add(1) + 1) < thread_count)
+        return false;
+
+      size_t total = ld_collected.exchange(0);
+      ld_swept = 0;
+      ld_rounds++;
+
+      uint64_t interval = ld_interval;
+      if (total == 0)
+        interval =
+          std::min(std::max<uint64_t>(interval, 1) * 2, ld_max_interval);
+      else
+        interval = ld_min_interval;
+
+      Systematic::cout() << "LD round collected " << total << " cowns, next in "
+                         << interval << " cycles" << std::endl;
+      ld_interval = interval;
+      last_ld_tsc = Aal::tick();
+      return true;
+    }
+
+    /**
+     * Take a parked thread, if there is one, and count it as active again.
+     * Must be called with `m` held.
+     **/
+    T* take_parked()
+    {
+      // Retired threads stay parked.
+      T** p = &parked;
+      while (*p != nullptr)
+      {
+        T* t = *p;
+        if (!t->is_retired())
+        {
+          *p = t->next_parked;
+          parked_count--;
+          active_thread_count++;
+          return t;
+        }
+        p = &t->next_parked;
+      }
+
+      return nullptr;
+    }
+
+    /**
+     * The number of threads the target may grow to. Must be called with `m`
+     * held.
+     **/
+    size_t max_threads()
+    {
+      if ((thread_limit == 0) || (thread_limit > thread_count))
+        return thread_count;
+
+      return thread_limit;
+    }
+
+    /**
+     * Wake a thread returned by `take_parked`. Must be called without `m`
+     * held.
+     **/
+    static void unpark(T* t)
+    {
+      Systematic::cout() << "Unparking thread " << t->systematic_id
+                         << std::endl;
+#ifdef USE_SYSTEMATIC_TESTING
+      cv_notify_one(t);
+#else
+      t->unpark();
+#endif
+    }
+
     bool pause(uint64_t tsc)
     {
 #ifndef USE_SYSTEMATIC_TESTING
-      if ((tsc - last_unpause_tsc) < TSC_PAUSE_SLOP)
+      if (((tsc - last_unpause_tsc) < park_spin) && !local()->is_retired())
         return false;
 #else
       UNUSED(tsc);
 #endif
+      T* me = local();
 
       {
         std::unique_lock<std::mutex> lock(m);
         Systematic::cout() << "Pausing" << std::endl;
         if (active_thread_count > 1)
         {
+          // We ran out of work, so there is at least one thread too many.
+          if (adaptive_threads && !me->is_retired() && (thread_target > 1))
+          {
+            thread_target--;
+            Systematic::cout() << "Thread target: " << thread_target
+                               << std::endl;
+          }
+
+          // Whoever wakes us takes us off the list and counts us as active.
+          bool holding = !me->muted.empty();
           active_thread_count--;
-#ifdef USE_SYSTEMATIC_TESTING
+          me->next_parked = parked;
+          me->parked_muted = holding;
+          parked = me;
+          parked_count++;
+          if (holding)
+            muted_parked++;
           lock.unlock();
+#ifdef USE_SYSTEMATIC_TESTING
           cv_wait();
-          lock.lock();
 #else
-          cv.wait(lock);
+          // A receiver may have caught up since we last looked.
+          Barrier::memory();
+          if (holding && me->muted_ready())
+            unpark_muted();
+
+          me->park();
 #endif
-          active_thread_count++;
+          if (holding)
+            muted_parked--;
           Systematic::cout() << "Unpausing" << std::endl;
           return true;
         }
@@ -475,21 +1003,26 @@ namespace verona::rt
         T* t = first_thread;
         do
         {
-          if (!t->q.is_empty())
+          if (
+            !t->q.is_empty() || !injected.is_empty() ||
+            !DeferredRelease::is_empty() || !FreezeTasks::is_empty())
           {
-// Something has been scheduled LIFO, and the unpause was missed,
-// restart everybody.
-#ifdef USE_SYSTEMATIC_TESTING
+            // Something has been scheduled LIFO, and the unpause was missed.
+            // Carry on looking for it, and get another thread to help.
+            t = take_parked();
             lock.unlock();
-            cv_notify_all();
-#else
-            cv.notify_all();
-#endif
+            if (t != nullptr)
+              unpark(t);
             return true;
           }
           t = t->next;
         } while (t != first_thread);
 
+        // The receivers of our muted cowns still have work, so the runtime
+        // is not idle.
+        if (!me->muted.empty())
+          return false;
+
         if (!allow_teardown)
         {
           assert((runtime_pausing & 1) == 0);
@@ -499,26 +1032,27 @@ namespace verona::rt
           t = first_thread;
           do
           {
-            if (!t->q.is_empty())
+            if (
+              !t->q.is_empty() || !injected.is_empty() ||
+              !DeferredRelease::is_empty() || !FreezeTasks::is_empty())
             {
               Systematic::cout() << "Still work left" << std::endl;
               runtime_pausing++;
-#ifdef USE_SYSTEMATIC_TESTING
-              cv_notify_all();
-#else
-              cv.notify_all();
-#endif
               return true;
             }
             t = t->next;
           } while (t != first_thread);
 
+          // This is a real wait, even under systematic testing, as only a
+          // thread outside the pool can wake us.
           Systematic::cout() << "Runtime pausing" << std::endl;
-          cv.wait(lock);
+          runtime_parked = me;
+          lock.unlock();
+          me->park();
+          lock.lock();
 
           Systematic::cout() << "Runtime unpausing" << std::endl;
           runtime_pausing++;
-          cv.notify_all();
 
           return true;
         }
@@ -526,6 +1060,8 @@ namespace verona::rt
         // Used to handle deallocating all the state of the threads.
         Systematic::cout() << "Teardown beginning" << std::endl;
         teardown_in_progress = true;
+        DeferredRelease::set_accepting(false);
+        FreezeTasks::set_accepting(false);
 
         t = first_thread;
 #ifdef USE_SYSTEMATIC_TESTING
@@ -537,18 +1073,23 @@ namespace verona::rt
           t = t->next;
         } while (t != first_thread);
         Systematic::cout() << "Teardown: all threads stopped" << std::endl;
+
+        parked = nullptr;
+        parked_count = 0;
       }
-      Systematic::cout() << "cv_notify_all() for teardown" << std::endl;
-#ifdef USE_SYSTEMATIC_TESTING
+      Systematic::cout() << "Unpark all for teardown" << std::endl;
       T* t = first_thread;
       do
       {
+#ifdef USE_SYSTEMATIC_TESTING
         t->cv.notify_all();
-        t = t->next;
-      } while (t != first_thread);
 #else
-      cv.notify_all();
+        // A thread that is not parked just has a spurious wakeup pending,
+        // which it never sees as it is stopping.
+        t->unpark();
 #endif
+        t = t->next;
+      } while (t != first_thread);
       Systematic::cout() << "Teardown: all threads beginning teardown"
                          << std::endl;
       return true;
@@ -562,14 +1103,19 @@ namespace verona::rt
       if ((pausing & 1) != 0)
       {
         // Prevent starvation by detecting if the pausing state has changed,
-        // even if it has paused again.
+        // even if it has paused again. The pausing thread may not have
+        // parked yet, or another thread may already be waking it.
         do
         {
-#ifdef USE_SYSTEMATIC_TESTING
-          cv_notify_all();
-#else
-          cv.notify_all();
-#endif
+          T* t;
+          {
+            std::unique_lock<std::mutex> lock(m);
+            t = runtime_parked;
+            runtime_parked = nullptr;
+          }
+
+          if (t != nullptr)
+            t->unpark();
         } while (runtime_pausing == pausing);
         Systematic::cout() << "Unpausing other threads." << std::endl;
 
@@ -581,25 +1127,147 @@ namespace verona::rt
       uint64_t elapsed = now - last_unpause_tsc;
       last_unpause_tsc = now;
 
-      if (elapsed < TSC_UNPAUSE_SLOP)
+      if (elapsed < park_spin / 2)
         return false;
 #endif
 
+      if (parked_count.load(std::memory_order_relaxed) == 0)
+        return false;
+
+      // Wake exactly one thread. If there is more work than it can handle, it
+      // will wake another when it schedules or steals it.
+      T* t;
       {
         std::unique_lock<std::mutex> lock(m);
+        t = take_parked();
 
-        if (active_thread_count == thread_count)
-          return false;
+        // All the active threads are busy, so bring back a retired one.
+        if (
+          (t == nullptr) && adaptive_threads &&
+          (thread_target < max_threads()))
+        {
+          thread_target++;
+          Systematic::cout() << "Thread target: " << thread_target << std::endl;
+          t = take_parked();
+        }
+      }
+
+      if (t == nullptr)
+        return false;
+
+      unpark(t);
+      Systematic::cout() << "Unpausing other threads." << std::endl;
+
+      return true;
+    }
+
+    /**
+     * Wake the threads that parked holding muted cowns, so that they can
+     * reschedule those whose receivers have caught up.
+     **/
+    void unpark_muted()
+    {
+      T* t = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        T** p = &parked;
+        while (*p != nullptr)
+        {
+          T* u = *p;
+          if (!u->parked_muted)
+          {
+            p = &u->next_parked;
+            continue;
+          }
+
+          *p = u->next_parked;
+          parked_count--;
+          active_thread_count++;
+          u->next_parked = t;
+          t = u;
+        }
+      }
+
+      while (t != nullptr)
+      {
+        // Once woken, a thread may park again and reuse `next_parked`.
+        T* next = t->next_parked;
+        unpark(t);
+        t = next;
+      }
+    }
+
+    /**
+     * Wake every parked thread, including retired ones. The leak detector
+     * needs a vote from every thread in the pool.
+     **/
+    bool unpause_all()
+    {
+      if (parked_count.load(std::memory_order_relaxed) == 0)
+        return false;
+
+      T* t;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        t = parked;
+        parked = nullptr;
+        active_thread_count += parked_count;
+        parked_count = 0;
+      }
+
+      if (t == nullptr)
+        return false;
+
+      Systematic::cout() << "Unpausing all threads." << std::endl;
+      while (t != nullptr)
+      {
+        // Once woken, a thread may park again and reuse `next_parked`.
+        T* next = t->next_parked;
+        unpark(t);
+        t = next;
       }
 
+      return true;
+    }
+
+    /**
+     * Give every thread a list of the other threads to steal from, ordered by
+     * the distance between the CPUs they will run on. Threads at the same
+     * distance keep the order of the ring, so that thieves spread out.
+     **/
+    void init_victims()
+    {
+      std::vector<T*> threads;
+      T* t = first_thread;
+      do
+      {
+        threads.push_back(t);
+        t = t->next;
+      } while (t != first_thread);
+
+      size_t n = threads.size();
+      for (size_t i = 0; i < n; i++)
+      {
+        auto& victims = threads[i]->victims;
+        victims.clear();
+
+        for (size_t k = 1; k < n; k++)
+        {
+          size_t j = (i + k) % n;
 #ifdef USE_SYSTEMATIC_TESTING
-      cv_notify_all();
+          // Threads are not pinned, so explore arbitrary topologies instead.
+          Distance d = (Distance)(rand_get_next() % DISTANCE_COUNT);
 #else
-      cv.notify_all();
+          Distance d = topology.distance(i, j);
 #endif
-      Systematic::cout() << "Unpausing other threads." << std::endl;
+          victims.push_back({threads[j], d});
+        }
 
-      return true;
+        std::stable_sort(
+          victims.begin(), victims.end(), [](auto& a, auto& b) {
+            return a.distance < b.distance;
+          });
+      }
     }
 
     void init_barrier()
@@ -6,6 +6,21 @@
 
 namespace verona::rt
 {
+  /**
+   * The parts of a leak detector round that are timed separately: bringing
+   * every thread into the protocol, scanning until all threads agree that
+   * they are done, and sweeping the cowns that were not reached.
+   **/
+  enum class LDPhase
+  {
+    PreScan,
+    Scan,
+    Sweep,
+    None
+  };
+
+  static constexpr size_t LD_PHASE_COUNT = (size_t)LDPhase::None;
+
   class ThreadState
   {
   public:
@@ -107,6 +122,26 @@ namespace verona::rt
       Finished,
     };
 
+    static LDPhase phase(State s)
+    {
+      switch (s)
+      {
+        case NotInLD:
+          return LDPhase::None;
+
+        case WantLD:
+        case PreScan:
+          return LDPhase::PreScan;
+
+        case Sweep:
+        case Finished:
+          return LDPhase::Sweep;
+
+        default:
+          return LDPhase::Scan;
+      }
+    }
+
   private:
     State state;
     bool retracted;
@@ -171,7 +206,17 @@ namespace verona::rt
               return vote<Scan, AllInScan>(total_votes);
 
             case Scan:
+            {
+              // A lone thread goes straight to Scan, and there are no
+              // others to vote it into AllInScan.
+              if (total_votes == 1)
+              {
+                reset<AllInScan>();
+                return AllInScan;
+              }
+
               return Scan;
+            }
 
             default:
               abort();
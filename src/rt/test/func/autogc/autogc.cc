@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * A long-lived cown holds a trace region, and each behaviour on it allocates
+ * lots of objects in the region, keeping only the last one. Nothing calls
+ * RegionTrace::gc, so the region only stays small if it is collected
+ * automatically at the end of behaviours.
+ *
+ * Another cown grows a fresh region in a behaviour that does not hold it,
+ * and sends it to itself. The behaviour that stores it allocates nothing,
+ * but must still collect it.
+ **/
+static constexpr size_t rounds = 20;
+static constexpr size_t per_round = 200;
+
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+struct Holder : public VCown<Holder>
+{
+  Node* root;
+  size_t round = 0;
+
+  Holder()
+  {
+    root = new Node;
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(root);
+  }
+};
+
+struct Churn : public VAction<Churn>
+{
+  Holder* h;
+
+  Churn(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    // Objects left over from earlier rounds must have been collected.
+    check(Region::debug_size(h->root) <= 2 * per_round + 1);
+
+    for (size_t i = 0; i < per_round; i++)
+      h->root->next = new (alloc, h->root) Node;
+
+    h->round++;
+    if (h->round < rounds)
+    {
+      Cown::schedule<Churn>(h, h);
+      return;
+    }
+
+    auto& stats = RegionTrace::get_gc_stats(h->root);
+    Systematic::cout() << "Auto GC ran " << stats.auto_collections
+                       << " times, freeing " << stats.bytes_freed << " bytes"
+                       << std::endl;
+    check(stats.auto_collections > 0);
+    check(stats.auto_collections == stats.collections);
+
+    Cown::release(alloc, h);
+  }
+};
+
+struct Receiver : public VCown<Receiver>
+{
+  Node* root = nullptr;
+
+  void trace(ObjectStack* fields) const
+  {
+    if (root != nullptr)
+      fields->push(root);
+  }
+};
+
+struct Inspect : public VAction<Inspect>
+{
+  Receiver* r;
+
+  Inspect(Receiver* r) : r(r) {}
+
+  void f()
+  {
+    check(Region::debug_size(r->root) == 2);
+    check(RegionTrace::get_gc_stats(r->root).auto_collections == 1);
+  }
+};
+
+struct Keep : public VAction<Keep>
+{
+  Receiver* r;
+  Node* root;
+
+  Keep(Receiver* r, Node* root) : r(r), root(root) {}
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(root);
+  }
+
+  void f()
+  {
+    r->root = root;
+    Cown::schedule<Inspect>(r, r);
+  }
+};
+
+struct Grow : public VAction<Grow>
+{
+  Receiver* r;
+
+  Grow(Receiver* r) : r(r) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    Node* root = new (alloc) Node;
+
+    for (size_t i = 0; i < per_round; i++)
+      root->next = new (alloc, root) Node;
+
+    Cown::schedule<Keep>(r, r, root);
+  }
+};
+
+void test_auto_gc()
+{
+  RegionTrace::set_auto_gc(true, 200, 4096);
+
+  auto h = new Holder;
+  Cown::schedule<Churn>(h, h);
+
+  auto r = new Receiver;
+  Cown::schedule<Grow, YesTransfer>(r, r);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+  harness.run(test_auto_gc);
+
+  RegionTrace::set_auto_gc(false);
+  return 0;
+}
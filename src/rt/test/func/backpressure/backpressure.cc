@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Several producers flood one consumer with bursts of messages, with
+ * back-pressure enabled. Bursts are longer than the consumer can process in
+ * one batch, so it becomes overloaded and the producers are muted. Every
+ * message must still be delivered exactly once.
+ *
+ * Systematic testing counts batches in messages, so there the consumer is
+ * certain to be overloaded and some producer must have been muted. On one
+ * core the interleaving is also fixed, so the consumer's backlog must stay
+ * well below what the producers could queue if they were never held back.
+ * With more threads, a receiver that catches up and is then not run for a
+ * while does not hold anyone back, so there is no such bound.
+ **/
+static constexpr size_t producers = 4;
+static constexpr size_t rounds = 4;
+static constexpr size_t burst = 150;
+
+static std::atomic<size_t> backlog = 0;
+static std::atomic<size_t> max_backlog = 0;
+static bool bounded = false;
+
+static void sent()
+{
+  size_t b = ++backlog;
+  size_t m = max_backlog.load(std::memory_order_relaxed);
+  while ((b > m) && !max_backlog.compare_exchange_weak(m, b))
+  {}
+}
+
+struct Consumer : public VCown<Consumer>
+{
+  size_t received = 0;
+
+  ~Consumer()
+  {
+    check(received == producers * rounds * burst);
+
+    Systematic::cout() << "Largest backlog: " << max_backlog << std::endl;
+#ifdef USE_SYSTEMATIC_TESTING
+    check(Scheduler::get_muted_count() > 0);
+    if (bounded)
+      check(max_backlog < producers * rounds * burst / 2);
+#endif
+  }
+};
+
+struct Producer : public VCown<Producer>
+{
+  Consumer* consumer;
+  size_t round = 0;
+
+  Producer(Consumer* consumer) : consumer(consumer) {}
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(consumer);
+  }
+};
+
+struct Consume : public VAction<Consume>
+{
+  Consumer* c;
+
+  Consume(Consumer* c) : c(c) {}
+
+  void f()
+  {
+    c->received++;
+    backlog--;
+  }
+};
+
+struct Produce : public VAction<Produce>
+{
+  Producer* p;
+
+  Produce(Producer* p) : p(p) {}
+
+  void f()
+  {
+    for (size_t i = 0; i < burst; i++)
+    {
+      sent();
+      Cown::schedule<Consume>(p->consumer, p->consumer);
+    }
+
+    p->round++;
+    Systematic::cout() << "Producer " << p << " finished round " << p->round
+                       << std::endl;
+
+    if (p->round < rounds)
+      Cown::schedule<Produce>(p, p);
+    else
+      Cown::release(ThreadAlloc::get(), p);
+  }
+};
+
+void test_back_pressure(bool single_core)
+{
+  Scheduler::set_back_pressure(true);
+  backlog = 0;
+  max_backlog = 0;
+  bounded = single_core;
+
+  auto* alloc = ThreadAlloc::get();
+  auto c = new Consumer;
+
+  for (size_t i = 0; i < producers; i++)
+  {
+    Cown::acquire(c);
+    auto p = new Producer(c);
+    Cown::schedule<Produce>(p, p);
+  }
+
+  Cown::release(alloc, c);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+  harness.run(test_back_pressure, harness.cores == 1);
+  return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Cowns repeatedly build and drop large regions, with subregions, and large
+ * immutable graphs, while these are released by idle threads. Checks that
+ * everything is eventually released, with and without the cap on queued
+ * memory being reached.
+ **/
+static std::atomic<size_t> live = 0;
+
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+  Node* sub = nullptr;
+
+  Node()
+  {
+    live++;
+  }
+
+  ~Node()
+  {
+    live--;
+  }
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (sub != nullptr)
+      st->push(sub);
+  }
+
+  void trace_possibly_iso(ObjectStack* st) const
+  {
+    trace(st);
+  }
+};
+
+/**
+ * Builds a region of `objects` objects, where each of the first few objects
+ * holds a smaller subregion, down to `depth` levels.
+ **/
+Node* make_region(Alloc* alloc, size_t objects, size_t depth)
+{
+  Node* root = new (alloc) Node;
+
+  for (size_t i = 0; i < objects; i++)
+  {
+    Node* n = new (alloc, root) Node;
+    n->next = root->next;
+    root->next = n;
+
+    if ((depth > 0) && (i < 4))
+      n->sub = make_region(alloc, objects / 4, depth - 1);
+  }
+
+  return root;
+}
+
+/**
+ * Builds an immutable list, where every element is its own SCC.
+ **/
+Node* make_immutable(Alloc* alloc, size_t objects)
+{
+  Node* root = new (alloc) Node;
+
+  for (size_t i = 0; i < objects; i++)
+  {
+    Node* n = new (alloc, root) Node;
+    n->next = root->next;
+    root->next = n;
+  }
+
+  Freeze::apply(alloc, root);
+  return root;
+}
+
+struct Holder : public VCown<Holder>
+{
+  size_t rounds;
+  size_t objects;
+
+  Holder(size_t rounds, size_t objects) : rounds(rounds), objects(objects) {}
+};
+
+struct Drop : public VAction<Drop>
+{
+  Holder* h;
+
+  Drop(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    Region::release(alloc, make_region(alloc, h->objects, 2));
+    Immutable::release(alloc, make_immutable(alloc, h->objects));
+
+    if (--h->rounds > 0)
+      Cown::schedule<Drop>(h, h);
+  }
+};
+
+void test_deferred_release(
+  size_t holders,
+  size_t rounds,
+  size_t objects,
+  size_t min_bytes,
+  size_t max_queued_bytes)
+{
+  auto* alloc = ThreadAlloc::get();
+  DeferredRelease::set_deferred_release(true, min_bytes, max_queued_bytes);
+
+  for (size_t i = 0; i < holders; i++)
+  {
+    auto h = new Holder(rounds, objects);
+    Cown::schedule<Drop>(h, h);
+    Cown::release(alloc, h);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+
+  size_t holders = harness.opt.is<size_t>("--holders", 4);
+  size_t rounds = harness.opt.is<size_t>("--rounds", 10);
+  size_t objects = harness.opt.is<size_t>("--objects", 200);
+
+  // Defer everything.
+  harness.run(
+    test_deferred_release, holders, rounds, objects, (size_t)0, SIZE_MAX);
+  check(live == 0);
+
+  auto stats = DeferredRelease::get_stats();
+  check(stats.deferred > 0);
+  check(stats.queued_bytes == 0);
+
+  // Run into the cap, so that some graphs are released straight away.
+  harness.run(
+    test_deferred_release,
+    holders,
+    rounds,
+    objects,
+    (size_t)0,
+    (size_t)(objects * sizeof(Node)));
+  check(live == 0);
+
+  stats = DeferredRelease::get_stats();
+  check(stats.over_cap > 0);
+  check(stats.queued_bytes == 0);
+
+  DeferredRelease::set_deferred_release(false);
+  return 0;
+}
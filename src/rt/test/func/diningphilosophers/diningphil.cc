@@ -203,5 +203,10 @@ int main(int argc, char** argv)
 
   harness.run(test_dining, phil, hunger, forks, &harness);
 
+  // Again, with fully acquired meals run straight after the behaviour that
+  // scheduled them.
+  Scheduler::set_inline_budget(8);
+  harness.run(test_dining, phil, hunger, forks, &harness);
+
   return 0;
 }
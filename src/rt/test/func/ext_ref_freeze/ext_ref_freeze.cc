@@ -7,7 +7,6 @@ using namespace snmalloc;
 using namespace verona::rt;
 
 // This only tests trace regions.
-// At the moment, it does not make sense to freeze arena regions.
 
 struct B : public VCown<B>
 {};
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * A cown holds a trace region with free lists enabled, and has several
+ * behaviours queued at once. Each behaviour makes garbage and collects it,
+ * so the next one can recycle it. A busy cown must keep its free lists from
+ * one behaviour to the next, and only hand them back once it runs out of
+ * messages, which the finaliser checks.
+ **/
+static constexpr size_t behaviours = 8;
+static constexpr size_t per_round = 100;
+
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+struct Holder : public VCown<Holder>
+{
+  Node* root;
+  size_t round = 0;
+
+  Holder()
+  {
+    root = new Node;
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(root);
+  }
+
+  void finaliser()
+  {
+    check(round == behaviours);
+    check(RegionTrace::debug_free_list_memory(root) == 0);
+  }
+};
+
+struct Step : public VAction<Step>
+{
+  Holder* h;
+
+  Step(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    Node* root = h->root;
+
+    // The previous behaviour left garbage in the free lists, and there was
+    // still work queued for this cown.
+    if (h->round > 0)
+      check(RegionTrace::debug_free_list_memory(root) > 0);
+
+    for (size_t i = 0; i < per_round; i++)
+    {
+      Node* n = new (alloc, root) Node;
+      n->next = root->next;
+      root->next = n;
+    }
+
+    root->next = nullptr;
+    RegionTrace::gc(alloc, root);
+    check(RegionTrace::debug_free_list_memory(root) > 0);
+
+    h->round++;
+    if (h->round > 1)
+      check(RegionTrace::get_gc_stats(root).reused_bytes > 0);
+  }
+};
+
+void test_free_lists()
+{
+  RegionTrace::set_free_lists(true);
+
+  auto* alloc = ThreadAlloc::get();
+  auto h = new Holder;
+
+  for (size_t i = 0; i < behaviours; i++)
+    Cown::schedule<Step>(h, h);
+
+  Cown::release(alloc, h);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+  harness.run(test_free_lists);
+
+  RegionTrace::set_free_lists(false);
+  return 0;
+}
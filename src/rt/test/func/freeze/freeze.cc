@@ -9,8 +9,8 @@
 using namespace snmalloc;
 using namespace verona::rt;
 
-// This only tests trace regions.
-// At the moment, it does not make sense to freeze arena regions.
+// Most of these test trace regions. Arena regions are frozen into a single
+// SCC, and are tested by test_arena*.
 
 struct C1 : public V<C1>
 {
@@ -307,6 +307,230 @@ void test_two_rings_2()
   snmalloc::current_alloc_pool()->debug_check_empty();
 }
 
+static size_t arena_finalised = 0;
+static size_t arena_destructed = 0;
+
+struct A : public V<A, RegionType::Arena>
+{
+  Object* f1 = nullptr;
+  Object* f2 = nullptr;
+  Object* f3 = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (f1 != nullptr)
+      st->push(f1);
+
+    if (f2 != nullptr)
+      st->push(f2);
+
+    if (f3 != nullptr)
+      st->push(f3);
+  }
+};
+
+struct AFinal : public V<AFinal, RegionType::Arena>
+{
+  Object* f1 = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (f1 != nullptr)
+      st->push(f1);
+  }
+
+  void finaliser()
+  {
+    arena_finalised++;
+  }
+
+  ~AFinal()
+  {
+    arena_destructed++;
+  }
+};
+
+struct ALarge : public V<ALarge, RegionType::Arena>
+{
+  Object* f1 = nullptr;
+  // Too large for an arena, so this goes in the large object ring.
+  uint8_t data[16 * 1024] = {};
+
+  void trace(ObjectStack* st) const
+  {
+    if (f1 != nullptr)
+      st->push(f1);
+  }
+};
+
+void test_arena()
+{
+  // Freeze an arena region, with objects in arenas and in the large object
+  // ring, an unreachable object, a trace subregion, an arena subregion and
+  // references to an existing immutable.
+  //
+  // root  -> a1, large, sub
+  // a1    -> a2, root, imm
+  // a2    -> fin, imm, asub
+  // large -> a1
+  // fin   -> imm
+  // unreachable -> imm
+  auto* alloc = ThreadAlloc::get();
+  arena_finalised = 0;
+  arena_destructed = 0;
+
+  C1* imm = new (alloc) C1;
+  Freeze::apply(alloc, imm);
+
+  A* root = new (alloc) A;
+  A* a1 = new (alloc, root) A;
+  A* a2 = new (alloc, root) A;
+  AFinal* fin = new (alloc, root) AFinal;
+  ALarge* large = new (alloc, root) ALarge;
+  AFinal* unreachable = new (alloc, root) AFinal;
+
+  C1* sub = new (alloc) C1;
+  sub->f1 = new (alloc, sub) C1;
+  sub->f1->f1 = sub;
+
+  A* asub = new (alloc) A;
+  asub->f1 = new (alloc, asub) A;
+
+  root->f1 = a1;
+  root->f2 = large;
+  root->f3 = sub;
+  a1->f1 = a2;
+  a1->f2 = root;
+  a1->f3 = imm;
+  a2->f1 = fin;
+  a2->f2 = imm;
+  a2->f3 = asub;
+  large->f1 = a1;
+  fin->f1 = imm;
+  unreachable->f1 = imm;
+
+  Freeze::apply(alloc, root);
+
+  // The whole region is one SCC, with a reference count for the entry point.
+  auto r = root->debug_immutable_root();
+  check(r != root);
+  check(r->debug_test_rc(1));
+  check(a1->debug_immutable_root() == r);
+  check(a2->debug_immutable_root() == r);
+  check(fin->debug_immutable_root() == r);
+  check(large->debug_immutable_root() == r);
+  check(unreachable->debug_immutable_root() == r);
+
+  // Subregions are frozen as usual.
+  auto sr = sub->debug_immutable_root();
+  check(sr->debug_test_rc(1));
+  check(sub->f1->debug_immutable_root() == sr);
+
+  auto ar = asub->debug_immutable_root();
+  check(ar != r);
+  check(ar->debug_test_rc(1));
+  check(((A*)asub->f1)->debug_immutable_root() == ar);
+
+  // One reference from us, and one from each field of the region.
+  check(imm->debug_test_rc(5));
+
+  // A reference into the middle of the region keeps all of it alive.
+  Immutable::acquire(a2);
+  check(r->debug_test_rc(2));
+  Immutable::release(alloc, a2);
+  check(r->debug_test_rc(1));
+  check(arena_finalised == 0);
+
+  Immutable::release(alloc, root);
+  check(arena_finalised == 2);
+  check(arena_destructed == 2);
+  check(imm->debug_test_rc(1));
+
+  Immutable::release(alloc, imm);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+void test_arena_large_root()
+{
+  // Freeze an arena region whose entry point is in the large object ring.
+  auto* alloc = ThreadAlloc::get();
+
+  ALarge* root = new (alloc) ALarge;
+  A* a = new (alloc, root) A;
+  ALarge* large = new (alloc, root) ALarge;
+
+  root->f1 = a;
+  a->f1 = root;
+  a->f2 = large;
+
+  Freeze::apply(alloc, root);
+
+  auto r = root->debug_immutable_root();
+  check(r->debug_test_rc(1));
+  check(a->debug_immutable_root() == r);
+  check(large->debug_immutable_root() == r);
+
+  Immutable::release(alloc, root);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+struct TraceRoot : public V<TraceRoot>
+{
+  Object* f1 = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (f1 != nullptr)
+      st->push(f1);
+  }
+};
+
+void test_arena_adopted()
+{
+  // Freeze a trace region that an arena region has been merged into. It is
+  // collected, and then frozen as an arena region.
+  //
+  // root -> a1
+  // a1   -> fin, large
+  auto* alloc = ThreadAlloc::get();
+  arena_finalised = 0;
+  arena_destructed = 0;
+
+  TraceRoot* root = new (alloc) TraceRoot;
+  new (alloc, root) C1;
+
+  A* a1 = new (alloc) A;
+  AFinal* fin = new (alloc, a1) AFinal;
+  ALarge* large = new (alloc, a1) ALarge;
+  new (alloc, a1) AFinal;
+  a1->f1 = fin;
+  a1->f2 = large;
+
+  RegionTrace::merge(alloc, root, a1);
+  root->f1 = a1;
+
+  Freeze::apply(alloc, root);
+
+  // The unreachable objects were collected before freezing.
+  check(arena_finalised == 1);
+  check(arena_destructed == 1);
+
+  auto r = root->debug_immutable_root();
+  check(r != root);
+  check(r->debug_test_rc(1));
+  check(a1->debug_immutable_root() == r);
+  check(fin->debug_immutable_root() == r);
+  check(large->debug_immutable_root() == r);
+
+  Immutable::release(alloc, root);
+  check(arena_finalised == 2);
+  check(arena_destructed == 2);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
 void test_random(size_t seed = 1, size_t max_edges = 128)
 {
   snmalloc::current_alloc_pool()->debug_check_empty();
@@ -458,6 +682,9 @@ int main(int, char**)
   test_two_rings_1();
   test_two_rings_2();
   freeze_weird_ring();
+  test_arena();
+  test_arena_large_root();
+  test_arena_adopted();
 
   for (size_t i = 1; i < 10000; i++)
   {
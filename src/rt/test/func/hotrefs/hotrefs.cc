@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Cowns take references to shared immutables and a shared cown from their
+ * thread's hot reserve, and drop them into the reserve, directly, or on
+ * another cown. There are more immutables than reserve slots, so reserves
+ * are also evicted. The harness checks that every object is freed once the
+ * last reference is gone, wherever it was taken from.
+ **/
+
+struct Value : public V<Value>
+{
+  Value* next = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+struct Shared : public VCown<Shared>
+{};
+
+static constexpr size_t VALUES = 20;
+
+struct Holder : public VCown<Holder>
+{
+  Value* values[VALUES];
+  Shared* shared;
+  size_t rounds;
+
+  Holder(Value** values, Shared* shared, size_t rounds)
+  : shared(shared), rounds(rounds)
+  {
+    for (size_t i = 0; i < VALUES; i++)
+    {
+      this->values[i] = values[i];
+      Immutable::acquire(values[i]);
+    }
+
+    Cown::acquire(shared);
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    for (size_t i = 0; i < VALUES; i++)
+      fields->push(values[i]);
+
+    fields->push(shared);
+  }
+};
+
+struct Drop : public VAction<Drop>
+{
+  Shared* shared;
+  Value* value;
+
+  Drop(Shared* shared, Value* value) : shared(shared), value(value) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    check(value->next->next == value);
+
+    Immutable::release(alloc, value);
+    Cown::release(alloc, shared);
+  }
+};
+
+struct Use : public VAction<Use>
+{
+  Holder* h;
+
+  Use(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    Epoch e(alloc);
+
+    for (size_t i = 0; i < VALUES; i++)
+    {
+      // Take more than a batch, so the reserve is refilled.
+      Value* v = h->values[i];
+      for (size_t j = 0; j < 100; j++)
+        e.acquire_hot(v);
+
+      // Hand one to another cown, which drops it directly.
+      e.acquire_hot(h->shared);
+      Cown::schedule<Drop>(h->shared, h->shared, v);
+
+      // Return some through the other object in the SCC, and the rest
+      // directly.
+      for (size_t j = 0; j < 50; j++)
+        e.release_hot(v->next);
+      for (size_t j = 0; j < 49; j++)
+        Immutable::release(alloc, v);
+
+      // Return more than were taken, so the reserve spills.
+      for (size_t j = 0; j < 200; j++)
+        Immutable::acquire(v);
+      for (size_t j = 0; j < 200; j++)
+        e.release_hot(v);
+    }
+
+    if (--h->rounds > 0)
+      Cown::schedule<Use>(h, h);
+  }
+};
+
+void test_hotrefs(size_t holders, size_t rounds)
+{
+  auto* alloc = ThreadAlloc::get();
+  Value* values[VALUES];
+
+  for (size_t i = 0; i < VALUES; i++)
+  {
+    Value* v = new (alloc) Value;
+    v->next = new (alloc, v) Value;
+    v->next->next = v;
+    Freeze::apply(alloc, v);
+    values[i] = v;
+  }
+
+  Shared* shared = new Shared;
+
+  for (size_t i = 0; i < holders; i++)
+  {
+    auto h = new Holder(values, shared, rounds);
+    Cown::schedule<Use>(h, h);
+    Cown::release(alloc, h);
+  }
+
+  for (size_t i = 0; i < VALUES; i++)
+    Immutable::release(alloc, values[i]);
+
+  Cown::release(alloc, shared);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+
+  size_t holders = harness.opt.is<size_t>("--holders", 4);
+  size_t rounds = harness.opt.is<size_t>("--rounds", 4);
+
+  harness.run(test_hotrefs, holders, rounds);
+
+  return 0;
+}
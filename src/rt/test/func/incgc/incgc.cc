@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * A long-lived cown holds a trace region that is collected automatically,
+ * sweeping only a few objects at the end of each behaviour. Each behaviour
+ * allocates lots of objects, some with finalisers, while an earlier
+ * collection is still being swept, and replaces a cown held in the region's
+ * RememberedSet, so new objects and entries must survive the sweep in
+ * progress.
+ **/
+static constexpr size_t rounds = 40;
+static constexpr size_t per_round = 200;
+static constexpr size_t slice = 16;
+
+static std::atomic<size_t> live_tracked = 0;
+
+struct Leaf : public VCown<Leaf>
+{
+  size_t touched = 0;
+};
+
+struct Touch : public VAction<Touch>
+{
+  Leaf* leaf;
+
+  Touch(Leaf* leaf) : leaf(leaf) {}
+
+  void f()
+  {
+    leaf->touched++;
+  }
+};
+
+struct Tracked : public V<Tracked>
+{
+  enum State
+  {
+    LIVE,
+    FINALISED,
+  };
+
+  State state = LIVE;
+  Tracked* next = nullptr;
+
+  Tracked()
+  {
+    live_tracked++;
+  }
+
+  void trace(ObjectStack* st) const
+  {
+    check(state == LIVE || state == FINALISED);
+
+    if (next != nullptr)
+      st->push(next);
+  }
+
+  void finaliser()
+  {
+    check(state == LIVE);
+
+    // Finalisers may look at other garbage, which must not have been swept.
+    if (next != nullptr)
+      check(next->state == LIVE || next->state == FINALISED);
+
+    state = FINALISED;
+  }
+
+  ~Tracked()
+  {
+    check(state == FINALISED);
+    live_tracked--;
+  }
+};
+
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+  Tracked* tracked = nullptr;
+  Leaf* leaf = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (tracked != nullptr)
+      st->push(tracked);
+
+    if (leaf != nullptr)
+      st->push(leaf);
+  }
+};
+
+struct Holder : public VCown<Holder>
+{
+  Node* root;
+  size_t round = 0;
+
+  Holder()
+  {
+    root = new Node;
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(root);
+  }
+};
+
+struct Churn : public VAction<Churn>
+{
+  Holder* h;
+
+  Churn(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    Node* root = h->root;
+
+    // The cown held by the last round must still be alive.
+    if (root->leaf != nullptr)
+      Cown::schedule<Touch>(root->leaf, root->leaf);
+
+    for (size_t i = 0; i < per_round; i++)
+    {
+      root->next = new (alloc, root) Node;
+
+      if ((i % 4) == 0)
+      {
+        auto t = new (alloc, root) Tracked;
+        t->next = root->tracked;
+        root->tracked = ((i % 16) == 0) ? t : nullptr;
+      }
+    }
+
+    root->leaf = new Leaf;
+    RegionTrace::insert<YesTransfer>(alloc, root, root->leaf);
+
+    h->round++;
+    if (h->round < rounds)
+    {
+      Cown::schedule<Churn>(h, h);
+      return;
+    }
+
+    auto& stats = RegionTrace::get_gc_stats(root);
+    Systematic::cout() << "Auto GC ran " << stats.auto_collections
+                       << " times in " << stats.sweep_slices
+                       << " extra slices, freeing " << stats.bytes_freed
+                       << " bytes" << std::endl;
+    check(stats.auto_collections > 0);
+    check(stats.sweep_slices > 0);
+
+    // An explicit collection finishes the one in progress, and then leaves
+    // only what is reachable.
+    RegionTrace::gc(alloc, root);
+    size_t live = 1 + (root->next != nullptr) + (root->tracked != nullptr);
+    if (root->tracked != nullptr)
+      live += (root->tracked->next != nullptr);
+    check(Region::debug_size(root) == live);
+
+    Cown::release(alloc, h);
+  }
+};
+
+/**
+ * Start an incremental collection, and resolve external references to a
+ * live object and to garbage that has not been swept yet. Only the live one
+ * may still resolve.
+ **/
+struct Resolve : public VAction<Resolve>
+{
+  Holder* h;
+
+  Resolve(Holder* h) : h(h) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    Node* root = h->root;
+    auto region = Region::get(root);
+
+    // Allocate the garbage first, so that it is among the last to be swept.
+    auto dead = new (alloc, root) Node;
+    auto ext_dead = ExternalRef::create(region, dead);
+
+    for (size_t i = 0; i < per_round; i++)
+      root->next = new (alloc, root) Node;
+
+    auto live = root->next;
+    auto ext_live = ExternalRef::create(region, live);
+
+    RegionTrace::gc_if_grown(alloc, root);
+    check(RegionTrace::get_gc_stats(root).auto_collections == 1);
+    check(RegionTrace::sweeps_pending());
+
+    check(!ext_dead->is_in(region));
+    check(ext_live->is_in(region));
+    check(ext_live->get() == live);
+
+    RegionTrace::finish_gc(alloc, root);
+    check(ext_live->is_in(region));
+
+    Immutable::release(alloc, ext_dead);
+    Immutable::release(alloc, ext_live);
+  }
+};
+
+void test_ext_ref_mid_sweep()
+{
+  RegionTrace::set_auto_gc(true, 200, 4096);
+  RegionTrace::set_incremental_gc(slice);
+
+  auto* alloc = ThreadAlloc::get();
+  auto h = new Holder;
+  Cown::schedule<Resolve>(h, h);
+  Cown::release(alloc, h);
+}
+
+void test_incremental_gc()
+{
+  RegionTrace::set_auto_gc(true, 200, 4096);
+  RegionTrace::set_incremental_gc(slice);
+
+  auto h = new Holder;
+  Cown::schedule<Churn>(h, h);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+  harness.run(test_incremental_gc);
+  harness.run(test_ext_ref_mid_sweep);
+
+  RegionTrace::set_incremental_gc(0);
+  RegionTrace::set_auto_gc(false);
+
+  check(live_tracked == 0);
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Creates cycles of cowns, which only the leak detector can collect, while
+ * nothing asks for it to run.
+ *
+ * With pacing on, the scheduler threads start rounds themselves, so the
+ * cycles are collected while the program is still running. The last step
+ * keeps going until that has happened. With pacing off, the leak detector
+ * must not run until teardown.
+ **/
+std::atomic<size_t> collected = 0;
+
+struct Cell : public VCown<Cell>
+{
+  Cell* next = nullptr;
+
+  ~Cell()
+  {
+    collected++;
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    if (next != nullptr)
+      fields->push(next);
+  }
+};
+
+struct Driver : public VCown<Driver>
+{};
+
+struct Step : public VAction<Step>
+{
+  Driver* d;
+  size_t steps;
+  bool automatic;
+
+  Step(Driver* d, size_t steps, bool automatic)
+  : d(d), steps(steps), automatic(automatic)
+  {}
+
+  void f()
+  {
+    if (steps > 0)
+    {
+      // Each cell holds the only reference to the other.
+      Cell* a = new Cell;
+      Cell* b = new Cell;
+      a->next = b;
+      b->next = a;
+
+      Cown::schedule<Step>(d, d, steps - 1, automatic);
+      return;
+    }
+
+    if (!automatic)
+    {
+      check(Scheduler::get_ld_rounds() == 0);
+      check(collected == 0);
+      return;
+    }
+
+    // Wait for a round that collected some of the cycles.
+    if (collected == 0)
+      Cown::schedule<Step>(d, d, 0, automatic);
+  }
+};
+
+void test_pacing(size_t steps, bool automatic)
+{
+  auto* alloc = ThreadAlloc::get();
+
+  // Start a new round whenever the last one has finished.
+  Scheduler::set_ld_pacing(automatic, 0, 0);
+  collected = 0;
+
+  Driver* d = new Driver;
+  Cown::schedule<Step>(d, d, steps, automatic);
+  Cown::release(alloc, d);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+
+  size_t steps = harness.opt.is<size_t>("--steps", 100);
+
+  harness.run(test_pacing, steps, true);
+  harness.run(test_pacing, steps, false);
+
+  Scheduler::set_ld_pacing(false);
+  return 0;
+}
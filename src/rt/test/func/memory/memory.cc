@@ -3,9 +3,12 @@
 #include "memory.h"
 
 #include "memory_alloc.h"
+#include "memory_freelist.h"
 #include "memory_gc.h"
+#include "memory_generational.h"
 #include "memory_iterator.h"
 #include "memory_merge.h"
+#include "memory_stats.h"
 #include "memory_subregion.h"
 #include "memory_swap_root.h"
 
@@ -66,6 +69,9 @@ int main(int argc, char** argv)
   memory_merge::run_test();
   memory_gc::run_test();
   memory_subregion::run_test();
+  memory_stats::run_test();
+  memory_freelist::run_test();
+  memory_generational::run_test();
 
   test_alloc_pool();
   test_dealloc();
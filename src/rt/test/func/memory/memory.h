@@ -149,19 +149,19 @@ struct F3 : public V<F3<region_type>, region_type>
   }
 };
 
-// Only two can fit into an Arena.
+// Only two can fit into the largest Arena.
 template<RegionType region_type>
 using MediumC2 = C2<400 * 1024 - 4 * sizeof(uintptr_t), region_type>;
 template<RegionType region_type>
 using MediumF2 = F2<400 * 1024 - 4 * sizeof(uintptr_t), region_type>;
 
-// Fits exactly into an Arena.
+// Fits exactly into the largest Arena.
 template<RegionType region_type>
 using LargeC2 = C2<1024 * 1024 - 4 * sizeof(uintptr_t), region_type>;
 template<RegionType region_type>
 using LargeF2 = F2<1024 * 1024 - 4 * sizeof(uintptr_t), region_type>;
 
-// Too large for Arena.
+// Too large for any Arena.
 template<RegionType region_type>
 using XLargeC2 = C2<1024 * 1024 - 4 * sizeof(uintptr_t) + 1, region_type>;
 template<RegionType region_type>
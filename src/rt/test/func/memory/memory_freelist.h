@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include "memory.h"
+
+namespace memory_freelist
+{
+  /**
+   * Tests that swept objects, trivial and non-trivial, are recycled for
+   * later allocations in the same region.
+   **/
+  void test_recycle()
+  {
+    using C = C1<RegionType::Trace>;
+    using F = F1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+
+    C* r = new (alloc) C;
+    C* c = new (alloc, r) C;
+    F* f = new (alloc, r) F;
+    RegionTrace::gc(alloc, r);
+
+    assert(live_count == 0);
+    assert(RegionTrace::debug_free_list_memory(r) >= sizeof(C) + sizeof(F));
+
+    // The most recently swept block of the same size class comes back first.
+    C* c2 = new (alloc, r) C;
+    F* f2 = new (alloc, r) F;
+    assert((Object*)c2 == (Object*)c || (Object*)c2 == (Object*)f);
+    assert((Object*)f2 == (Object*)c || (Object*)f2 == (Object*)f);
+    assert(RegionTrace::debug_free_list_memory(r) == 0);
+    assert(RegionTrace::get_gc_stats(r).reused_bytes == sizeof(C) + sizeof(F));
+    UNUSED(c);
+    UNUSED(f);
+    UNUSED(c2);
+    UNUSED(f2);
+
+    r->f1 = c2;
+    RegionTrace::gc(alloc, r);
+    assert(live_count == 0);
+    assert(RegionTrace::debug_free_list_memory(r) > 0);
+
+    // Releasing the region releases its free lists.
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+  }
+
+  /**
+   * Tests that a region keeps no more than the cap in its free lists, and
+   * that they can be handed back to snmalloc.
+   **/
+  void test_cap()
+  {
+    using C = C1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    size_t cap = 64 * sizeof(C);
+    RegionTrace::set_free_lists(true, cap);
+
+    C* r = new (alloc) C;
+    for (size_t i = 0; i < 1000; i++)
+      new (alloc, r) C;
+
+    RegionTrace::gc(alloc, r);
+    size_t kept = RegionTrace::debug_free_list_memory(r);
+    assert(kept > 0);
+    assert(kept <= cap);
+
+    size_t trimmed = RegionTrace::trim_free_lists(alloc, r);
+    assert(trimmed == kept);
+    assert(RegionTrace::debug_free_list_memory(r) == 0);
+    UNUSED(kept);
+    UNUSED(trimmed);
+
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    RegionTrace::set_free_lists(true);
+  }
+
+  /**
+   * Tests that merging, and turning a trace region into an arena region,
+   * hands the free lists of the region that goes away back to snmalloc.
+   **/
+  void test_merge()
+  {
+    using C = C1<RegionType::Trace>;
+    using AC = C1<RegionType::Arena>;
+    auto* alloc = ThreadAlloc::get();
+
+    C* r1 = new (alloc) C;
+    C* r2 = new (alloc) C;
+    for (size_t i = 0; i < 10; i++)
+    {
+      new (alloc, r1) C;
+      new (alloc, r2) C;
+    }
+    RegionTrace::gc(alloc, r1);
+    RegionTrace::gc(alloc, r2);
+
+    size_t kept = RegionTrace::debug_free_list_memory(r1);
+    RegionTrace::merge(alloc, r1, r2);
+    assert(RegionTrace::debug_free_list_memory(r1) == kept);
+    UNUSED(kept);
+
+    r1->f1 = r2;
+    AC* a = new (alloc) AC;
+    RegionArena::merge(alloc, a, r1);
+
+    Region::release(alloc, a);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+  }
+
+  void run_test()
+  {
+    RegionTrace::set_free_lists(true);
+
+    test_recycle();
+    test_cap();
+    test_merge();
+
+    RegionTrace::set_free_lists(false);
+  }
+}
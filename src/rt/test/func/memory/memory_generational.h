@@ -0,0 +1,223 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include "memory.h"
+
+namespace memory_generational
+{
+  size_t objects(Object* o)
+  {
+    size_t n = 0;
+    for (auto p : *RegionTrace::get(o))
+    {
+      UNUSED(p);
+      n++;
+    }
+    return n;
+  }
+
+  /**
+   * Tests that a minor collection only collects the nursery, and that
+   * mature garbage is left for the next major collection.
+   **/
+  void test_minor()
+  {
+    using C = C1<RegionType::Trace>;
+    using F = F1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    RegionTrace::set_generational(true, 64 * 1024, 2);
+
+    C* r = new (alloc) C;
+    r->f1 = new (alloc, r) C;
+    r->f2 = new (alloc, r) C;
+    new (alloc, r) F;
+
+    // Everything is in the nursery, so this collects the garbage.
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 3);
+    assert(live_count == 0);
+
+    // Turn a mature object into garbage, and add some to the nursery.
+    r->f2 = nullptr;
+    new (alloc, r) F;
+    new (alloc, r) C;
+    assert(objects(r) == 5);
+
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 3);
+    assert(live_count == 0);
+    assert(RegionTrace::get_gc_stats(r).minor_collections == 2);
+
+    // Every other collection is a major one.
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 2);
+    assert(RegionTrace::get_gc_stats(r).minor_collections == 2);
+    assert(RegionTrace::get_gc_stats(r).collections == 3);
+
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+  }
+
+  /**
+   * Tests that nursery objects only referred to by mature objects survive a
+   * minor collection if the mature objects were written to through the
+   * write barrier.
+   **/
+  void test_barrier()
+  {
+    using F = F1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    RegionTrace::set_generational(true, 64 * 1024, 100);
+
+    F* r = new (alloc) F;
+    F* m = new (alloc, r) F;
+    r->f1 = m;
+    RegionTrace::gc(alloc, r);
+
+    // m is mature, and the only way to reach a chain of new objects.
+    F* n = new (alloc, r) F;
+    n->f1 = new (alloc, r) F;
+    m->f1 = n;
+    RegionTrace::write_barrier(alloc, r, m);
+    new (alloc, r) F;
+
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 4);
+    assert(live_count == 4);
+
+    // Once promoted, the chain no longer needs the barrier.
+    m->f2 = n->f1;
+    n->f1 = nullptr;
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 4);
+
+    m->f1 = nullptr;
+    m->f2 = nullptr;
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 4);
+
+    // Swapping the root puts everything back in the nursery.
+    RegionTrace::swap_root(r, m);
+    RegionTrace::gc(alloc, m);
+    assert(objects(m) == 1);
+    assert(live_count == 1);
+
+    Region::release(alloc, m);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  /**
+   * Tests that writing to too many objects makes the next collection a
+   * major one.
+   **/
+  void test_overflow()
+  {
+    using C = C1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    RegionTrace::set_generational(true, 64 * 1024, 100, 4);
+
+    C* r = new (alloc) C;
+    C* list = nullptr;
+    for (size_t i = 0; i < 10; i++)
+    {
+      C* c = new (alloc, r) C;
+      c->f1 = list;
+      list = c;
+    }
+    r->f1 = list;
+    RegionTrace::gc(alloc, r);
+
+    for (C* c = list; c != nullptr; c = c->f1)
+      RegionTrace::write_barrier(alloc, r, c);
+
+    r->f1 = nullptr;
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 1);
+    assert(RegionTrace::get_gc_stats(r).minor_collections == 1);
+
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+  }
+
+  /**
+   * Tests that objects merged in survive a minor collection, even though
+   * storing their Iso object into a mature object goes through no barrier.
+   **/
+  void test_merge()
+  {
+    using F = F1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    RegionTrace::set_generational(true, 64 * 1024, 100);
+
+    F* r = new (alloc) F;
+    F* m = new (alloc, r) F;
+    r->f1 = m;
+    RegionTrace::gc(alloc, r);
+
+    F* o = new (alloc) F;
+    o->f1 = new (alloc, o) F;
+    new (alloc, o) F;
+
+    m->f1 = o;
+    RegionTrace::merge(alloc, r, o);
+    assert(objects(r) == 5);
+
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 4);
+    assert(live_count == 4);
+    assert(RegionTrace::get_gc_stats(r).minor_collections == 2);
+
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  /**
+   * Shows why C++ stores into a mature object must call the write barrier.
+   * Without it, a minor collection cannot see the reference, and frees the
+   * object stored.
+   **/
+  void test_missing_barrier()
+  {
+    using F = F1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+    RegionTrace::set_generational(true, 64 * 1024, 100);
+
+    F* r = new (alloc) F;
+    F* m = new (alloc, r) F;
+    r->f1 = m;
+    RegionTrace::gc(alloc, r);
+
+    // No barrier: the new object is freed, and m->f1 is left dangling.
+    m->f1 = new (alloc, r) F;
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 2);
+    assert(live_count == 2);
+    m->f1 = nullptr;
+
+    // With the barrier, it survives.
+    m->f1 = new (alloc, r) F;
+    RegionTrace::write_barrier(alloc, r, m);
+    RegionTrace::gc(alloc, r);
+    assert(objects(r) == 3);
+    assert(live_count == 3);
+    assert(RegionTrace::get_gc_stats(r).minor_collections == 3);
+
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  void run_test()
+  {
+    test_minor();
+    test_barrier();
+    test_missing_barrier();
+    test_overflow();
+    test_merge();
+
+    RegionTrace::set_generational(false);
+  }
+}
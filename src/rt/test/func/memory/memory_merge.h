@@ -324,9 +324,115 @@ namespace memory_merge
     }
   }
 
+  /**
+   * A trace object that can refer to an object of any type.
+   **/
+  struct Holder : public V<Holder>
+  {
+    Object* o = nullptr;
+
+    void trace(ObjectStack* st) const
+    {
+      if (o != nullptr)
+        st->push(o);
+    }
+  };
+
+  /**
+   * Merges an arena region into a trace region, and checks that the objects
+   * in the adopted arenas are still collected.
+   **/
+  void test_merge_arena_into_trace()
+  {
+    using AC = C1<RegionType::Arena>;
+    using AF = F1<RegionType::Arena>;
+    using AXF = XLargeF2<RegionType::Arena>;
+
+    auto* alloc = ThreadAlloc::get();
+    auto* r1 = alloc_region<Holder, C1<RegionType::Trace>>(alloc);
+
+    // A list long enough to fill several arenas, and some garbage.
+    auto* r2 = new (alloc) AF;
+    AF* curr = r2;
+    AF* middle = nullptr;
+    for (size_t i = 0; i < 1000; i++)
+    {
+      AF* n = new (alloc, r2) AF;
+      curr->f1 = n;
+      curr = n;
+
+      if (i == 500)
+        middle = n;
+    }
+    alloc_in_region<AC, AC, AXF, AF>(alloc, r2);
+    assert(live_count == 1003);
+
+    RegionTrace::merge(alloc, r1, r2);
+    assert(!r2->debug_is_iso());
+    assert(Region::debug_size(r1) == 2 + 1001 + 4);
+
+    r1->o = r2;
+    RegionTrace::gc(alloc, r1);
+    assert(Region::debug_size(r1) == 1 + 1001);
+    assert(live_count == 1001);
+
+    // Cut the list in half, which empties some of the arenas.
+    size_t freed = RegionTrace::get_gc_stats(r1).bytes_freed;
+    middle->f1 = nullptr;
+    RegionTrace::gc(alloc, r1);
+    assert(Region::debug_size(r1) == 1 + 502);
+    assert(live_count == 502);
+    assert(RegionTrace::get_gc_stats(r1).bytes_freed > freed);
+    UNUSED(freed);
+
+    test_merge_helper<RegionType::Trace>(
+      alloc, r1, alloc_region<AF, AC, AXF>(alloc));
+  }
+
+  /**
+   * Merges trace regions, with and without adopted arenas, into an arena
+   * region.
+   **/
+  void test_merge_trace_into_arena()
+  {
+    using AF = F1<RegionType::Arena>;
+    using AXC = XLargeC2<RegionType::Arena>;
+    using TC = C1<RegionType::Trace>;
+    using TF = F1<RegionType::Trace>;
+
+    auto* alloc = ThreadAlloc::get();
+
+    // A trace region with an adopted arena, in which some objects are dead.
+    auto* r1 = alloc_region<Holder, TF, TC>(alloc);
+    auto* r2 = alloc_region<AF, AF, AF>(alloc);
+    r2->f1 = new (alloc, r2) AF;
+    RegionTrace::merge(alloc, r1, r2);
+    r1->o = r2;
+    RegionTrace::gc(alloc, r1);
+    assert(Region::debug_size(r1) == 3);
+
+    auto* r3 = alloc_region<AF, AF, AXC>(alloc);
+    RegionArena::merge(alloc, r3, r1);
+    assert(!r1->debug_is_iso());
+    assert(Region::debug_size(r3) == 3 + 3);
+
+    auto* r4 = alloc_region<TF, TC, TF>(alloc);
+    RegionArena::merge(alloc, r3, r4);
+    assert(Region::debug_size(r3) == 6 + 3);
+
+    // `r4` is now in the large object ring.
+    RegionArena::swap_root(r3, r4);
+    assert(r4->debug_is_iso());
+
+    test_merge_helper<RegionType::Arena>(
+      alloc, r4, alloc_region<TF, TC>(alloc));
+  }
+
   void run_test()
   {
     test_merge<RegionType::Trace>();
     test_merge<RegionType::Arena>();
+    test_merge_arena_into_trace();
+    test_merge_trace_into_arena();
   }
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+
+#include "memory.h"
+
+namespace memory_stats
+{
+  /**
+   * Checks the statistics kept by the region represented by the Iso object
+   * `o` against a walk of the region, and returns them.
+   **/
+  RegionStats check_stats(Object* o)
+  {
+    RegionStats stats = Region::get_stats(o);
+
+    size_t objects = 0;
+    size_t bytes = 0;
+    auto count = [&](Object* p) {
+      objects++;
+      bytes += p->get_descriptor()->size;
+    };
+
+    switch (Region::get_type(Region::get(o)))
+    {
+      case RegionType::Trace:
+        for (auto p : *RegionTrace::get(o))
+          count(p);
+        break;
+
+      case RegionType::Arena:
+        for (auto p : *RegionArena::get(o))
+          count(p);
+        assert(stats.arena_bytes == RegionArena::debug_arena_memory(o));
+        break;
+
+      default:
+        abort();
+    }
+
+    assert(stats.objects == objects);
+    assert(stats.live_bytes == bytes);
+    assert(stats.live_bytes == stats.arena_live_bytes + stats.large_bytes);
+    assert(stats.arena_bytes >= stats.arena_live_bytes);
+    assert((stats.arenas == 0) == (stats.arena_bytes == 0));
+    UNUSED(objects);
+    UNUSED(bytes);
+    return stats;
+  }
+
+  /**
+   * Tests the statistics of a region as objects are allocated and
+   * collected, and as its root is swapped.
+   **/
+  void test_trace()
+  {
+    using C = C1<RegionType::Trace>;
+    using F = F1<RegionType::Trace>;
+    using XC = XLargeC2<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+
+    C* r = new (alloc) C;
+    auto stats = check_stats(r);
+    assert(stats.objects == 1);
+    assert(stats.live_bytes == sizeof(C));
+    assert(stats.arenas == 0);
+
+    r->f1 = new (alloc, r) C;
+    r->f2 = new (alloc, r) C;
+    F* f = new (alloc, r) F;
+    r->f2->f1 = (C*)f;
+    new (alloc, r) XC;
+    new (alloc, r) F;
+
+    stats = check_stats(r);
+    assert(stats.objects == 6);
+    assert(stats.large_bytes == stats.live_bytes);
+
+    RegionTrace::gc(alloc, r);
+    stats = check_stats(r);
+    assert(stats.objects == 4);
+
+    RegionTrace::swap_root(r, r->f2);
+    auto swapped = check_stats(r->f2);
+    assert(swapped.objects == stats.objects);
+    assert(swapped.live_bytes == stats.live_bytes);
+
+    Region::release(alloc, r->f2);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  /**
+   * Tests the arena and large object statistics of an arena region.
+   **/
+  void test_arena()
+  {
+    using C = C1<RegionType::Arena>;
+    using F = F1<RegionType::Arena>;
+    using MC = MediumC2<RegionType::Arena>;
+    using XC = XLargeC2<RegionType::Arena>;
+    auto* alloc = ThreadAlloc::get();
+
+    C* r = new (alloc) C;
+    auto stats = check_stats(r);
+    assert(stats.objects == 1);
+    assert(stats.arenas == 1);
+    assert(stats.arena_live_bytes == sizeof(C));
+    assert(stats.arena_fragmentation() > 0);
+
+    for (size_t i = 0; i < 200; i++)
+      new (alloc, r) F;
+    new (alloc, r) XC;
+    new (alloc, r) MC;
+
+    stats = check_stats(r);
+    assert(stats.objects == 203);
+    assert(stats.arenas > 1);
+    assert(stats.large_bytes >= sizeof(XC) + sizeof(MC));
+
+    r->f1 = new (alloc, r) C;
+    RegionArena::swap_root(r, r->f1);
+    stats = check_stats(r->f1);
+    assert(stats.objects == 204);
+
+    Region::release(alloc, r->f1);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  /**
+   * Tests that merging adds up the statistics of both regions, and that a
+   * trace region that adopted arenas gives them up once they are empty.
+   **/
+  void test_merge()
+  {
+    using TC = C1<RegionType::Trace>;
+    using AC = C1<RegionType::Arena>;
+    using AF = F1<RegionType::Arena>;
+    auto* alloc = ThreadAlloc::get();
+
+    TC* t = new (alloc) TC;
+    t->f1 = new (alloc, t) TC;
+
+    AC* a = new (alloc) AC;
+    for (size_t i = 0; i < 10; i++)
+      new (alloc, a) AF;
+
+    auto before_t = check_stats(t);
+    auto before_a = check_stats(a);
+
+    RegionTrace::merge(alloc, t, a);
+    auto stats = check_stats(t);
+    assert(stats.objects == before_t.objects + before_a.objects);
+    assert(stats.live_bytes == before_t.live_bytes + before_a.live_bytes);
+    assert(stats.arenas == before_a.arenas);
+    assert(stats.arena_bytes == before_a.arena_bytes);
+
+    // Nothing in the adopted arena is reachable.
+    RegionTrace::gc(alloc, t);
+    stats = check_stats(t);
+    assert(stats.objects == before_t.objects);
+    assert(stats.arenas == 0);
+
+    AC* into = new (alloc) AC;
+    before_a = check_stats(into);
+    before_t = stats;
+
+    RegionArena::merge(alloc, into, t);
+    stats = check_stats(into);
+    assert(stats.objects == before_t.objects + before_a.objects);
+    assert(stats.large_bytes == before_t.large_bytes);
+
+    Region::release(alloc, into);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+    assert(live_count == 0);
+  }
+
+  /**
+   * Tests the RememberedSet and ExternalReferenceTable entries.
+   **/
+  void test_tables()
+  {
+    using C = C1<RegionType::Trace>;
+    auto* alloc = ThreadAlloc::get();
+
+    C* imm = new (alloc) C;
+    Freeze::apply(alloc, imm);
+
+    C* r = new (alloc) C;
+    r->f1 = new (alloc, r) C;
+    RegionTrace::insert(alloc, r, imm);
+    auto ext = ExternalRef::create(Region::get(r), r->f1);
+
+    auto stats = check_stats(r);
+    assert(stats.remembered_set == 1);
+    assert(stats.external_refs == 1);
+
+    Immutable::release(alloc, imm);
+    Immutable::release(alloc, ext);
+    Region::release(alloc, r);
+    snmalloc::current_alloc_pool()->debug_check_empty();
+  }
+
+  void run_test()
+  {
+    test_trace();
+    test_arena();
+    test_merge();
+    test_tables();
+  }
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "./noticeboard_basic.h"
+#include "./noticeboard_borrow.h"
 #include "./noticeboard_primitive_weak.h"
 #include "./noticeboard_weak.h"
 
@@ -11,6 +12,7 @@ int main(int argc, char** argv)
 {
   SystematicTestHarness harness(argc, argv);
   harness.run(noticeboard_basic::run_test);
+  harness.run(noticeboard_borrow::run_test);
   harness.run(noticeboard_weak::run_test);
   harness.run(noticeboard_primitive_weak::run_test);
   return 0;
@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+namespace noticeboard_borrow
+{
+  struct Alive : public VCown<Alive>
+  {};
+
+  struct Ping : public VAction<Ping>
+  {
+    Alive* alive;
+
+    Ping(Alive* alive) : alive(alive) {}
+
+    void f()
+    {
+      Systematic::cout() << "Ping on " << alive << std::endl;
+      Cown::release(ThreadAlloc::get(), alive);
+    }
+  };
+
+  // Each value is a pair of objects, whose counts always agree, and which
+  // refers to a cown that only the noticeboard keeps alive.
+  struct C : public V<C>
+  {
+  public:
+    size_t x;
+    C* next = nullptr;
+    Alive* alive = nullptr;
+
+    C(size_t x) : x(x) {}
+
+    void trace(ObjectStack* st) const
+    {
+      if (next != nullptr)
+        st->push(next);
+      if (alive != nullptr)
+        st->push(alive);
+    }
+  };
+
+  C* make_value(Alloc* alloc, size_t x)
+  {
+    C* c = new (alloc) C(x);
+    c->next = new (alloc, c) C(x + 1);
+
+    Alive* alive = new (alloc) Alive;
+    RegionTrace::insert<YesTransfer>(alloc, c, alive);
+    c->alive = alive;
+
+    Freeze::apply(alloc, c);
+    return c;
+  }
+
+  struct DB : public VCown<DB>
+  {
+  public:
+    Noticeboard<Object*> box;
+    size_t updates;
+
+    DB(Object* c, size_t updates) : box{c}, updates(updates)
+    {
+#ifdef USE_SYSTEMATIC_TESTING_WEAK_NOTICEBOARDS
+      register_noticeboard(&box);
+#endif
+    }
+
+    void trace(ObjectStack* fields) const
+    {
+      box.trace(fields);
+    }
+  };
+
+  struct Update : public VAction<Update>
+  {
+    DB* db;
+
+    Update(DB* db) : db(db) {}
+
+    void f()
+    {
+      auto* alloc = ThreadAlloc::get();
+      db->box.update(alloc, make_value(alloc, db->updates * 2));
+
+      if (--db->updates > 0)
+        Cown::schedule<Update>(db, db);
+    }
+  };
+
+  struct Reader : public VCown<Reader>
+  {
+  public:
+    DB* db;
+    size_t reads;
+
+    Reader(DB* db, size_t reads) : db(db), reads(reads)
+    {
+      Cown::acquire(db);
+    }
+
+    void trace(ObjectStack* fields) const
+    {
+      fields->push(db);
+    }
+  };
+
+  struct Read : public VAction<Read>
+  {
+    Reader* reader;
+
+    Read(Reader* reader) : reader(reader) {}
+
+    void f()
+    {
+      auto* alloc = ThreadAlloc::get();
+
+      {
+        auto c = reader->db->box.borrow(alloc);
+        auto value = (C*)c.get();
+        check(value->next->x == value->x + 1);
+
+        // Send to a cown reached only through the borrowed value.
+        if ((reader->reads % 4) == 0)
+        {
+          Cown::acquire(value->alive);
+          Cown::schedule<Ping>(value->alive, value->alive);
+        }
+      }
+
+      if (--reader->reads > 0)
+        Cown::schedule<Read>(reader, reader);
+    }
+  };
+
+  void run_test()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    DB* db = new DB(make_value(alloc, 0), 20);
+    Cown::schedule<Update>(db, db);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+      Reader* reader = new Reader(db, 20);
+      Cown::schedule<Read>(reader, reader);
+      Cown::release(alloc, reader);
+    }
+
+    Cown::release(alloc, db);
+    Scheduler::want_ld();
+  }
+}
@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Several cowns each build a region with many subregions and some
+ * unreachable objects, and freeze it, with every subregion and every few
+ * objects handed to other threads. Checks that the SCCs and reference counts
+ * are the same as a sequential freeze would give, and that everything is
+ * finalised and released.
+ **/
+static std::atomic<size_t> live = 0;
+
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+  Node* other = nullptr;
+  Node* sub = nullptr;
+
+  Node()
+  {
+    live++;
+  }
+
+  ~Node()
+  {
+    live--;
+  }
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (other != nullptr)
+      st->push(other);
+
+    if (sub != nullptr)
+      st->push(sub);
+  }
+};
+
+struct Garbage : public V<Garbage>
+{
+  std::atomic<size_t>* finalised;
+
+  Garbage(std::atomic<size_t>* finalised) : finalised(finalised)
+  {
+    live++;
+  }
+
+  ~Garbage()
+  {
+    live--;
+  }
+
+  void finaliser()
+  {
+    (*finalised)++;
+  }
+};
+
+/**
+ * Builds a subregion holding a doubly linked list, which is a single SCC,
+ * and `garbage` unreachable objects.
+ **/
+Node* make_list(
+  Alloc* alloc,
+  size_t objects,
+  size_t garbage,
+  std::atomic<size_t>* finalised)
+{
+  Node* root = new (alloc) Node;
+  Node* curr = root;
+
+  for (size_t i = 0; i < objects; i++)
+  {
+    Node* n = new (alloc, root) Node;
+    curr->next = n;
+    n->other = curr;
+    curr = n;
+  }
+
+  for (size_t i = 0; i < garbage; i++)
+    new (alloc, root) Garbage(finalised);
+
+  return root;
+}
+
+struct Freezer : public VCown<Freezer>
+{
+  size_t objects;
+  size_t garbage;
+  std::atomic<size_t> finalised = 0;
+
+  Freezer(size_t objects, size_t garbage) : objects(objects), garbage(garbage)
+  {}
+};
+
+struct Build : public VAction<Build>
+{
+  Freezer* freezer;
+
+  Build(Freezer* freezer) : freezer(freezer) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    size_t objects = freezer->objects;
+    size_t garbage = freezer->garbage;
+    auto finalised = &freezer->finalised;
+
+    // A chain of objects that are each their own SCC, all referring to
+    // `shared`, with a subregion hanging off every few of them.
+    Node* root = new (alloc) Node;
+    Node* shared = new (alloc, root) Node;
+    root->other = shared;
+
+    Node* curr = root;
+    for (size_t i = 0; i < objects; i++)
+    {
+      Node* n = new (alloc, root) Node;
+      n->other = shared;
+      if ((i % 4) == 0)
+        n->sub = make_list(alloc, objects, garbage, finalised);
+      curr->next = n;
+      curr = n;
+    }
+
+    for (size_t i = 0; i < garbage; i++)
+      new (alloc, root) Garbage(finalised);
+
+    Freeze::apply(alloc, root);
+
+    // Unreachable objects are finalised, wherever their region was frozen,
+    // before the freeze returns.
+    check(*finalised == garbage * (1 + (objects + 3) / 4));
+
+    check(root->debug_test_rc(1));
+    check(shared->debug_immutable_root() == shared);
+    check(shared->debug_test_rc(objects + 1));
+
+    for (Node* n = root->next; n != nullptr; n = n->next)
+    {
+      check(n->debug_immutable_root() == n);
+      check(n->debug_test_rc(1));
+
+      if (n->sub == nullptr)
+        continue;
+
+      Object* r = n->sub->debug_immutable_root();
+      check(r->debug_test_rc(1));
+      for (Node* m = n->sub; m != nullptr; m = m->next)
+        check(m->debug_immutable_root() == r);
+    }
+
+    Immutable::release(alloc, root);
+  }
+};
+
+void test_parallel_freeze(size_t freezers, size_t objects, size_t garbage)
+{
+  auto* alloc = ThreadAlloc::get();
+
+  // Share every subregion, and split every region into small slices.
+  Freeze::set_parallel_freeze(true, 0, 4);
+
+  for (size_t i = 0; i < freezers; i++)
+  {
+    auto f = new Freezer(objects, garbage);
+    Cown::schedule<Build>(f, f);
+    Cown::release(alloc, f);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+
+  size_t freezers = harness.opt.is<size_t>("--freezers", 4);
+  size_t objects = harness.opt.is<size_t>("--objects", 40);
+  size_t garbage = harness.opt.is<size_t>("--garbage", 3);
+
+  harness.run(test_parallel_freeze, freezers, objects, garbage);
+  Freeze::set_parallel_freeze(false);
+
+  check(live == 0);
+  return 0;
+}
@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+/**
+ * Grows and shrinks the set of active scheduler threads while work is running
+ * and the leak detector is collecting.
+ *
+ * A ring of cells, each holding a reference to the next, can only be
+ * collected by the leak detector. Several chains of hops travel round the
+ * ring. Each hop sets a new thread target, sometimes switches adaptive
+ * resizing on or off, and sometimes asks for a leak detector run, so that
+ * threads are retired and brought back in every phase of the protocol.
+ **/
+struct Cell : public VCown<Cell>
+{
+  size_t id;
+  Cell* next = nullptr;
+
+  Cell(size_t id) : id(id) {}
+
+  void trace(ObjectStack* fields) const
+  {
+    if (next != nullptr)
+      fields->push(next);
+  }
+};
+
+struct Hop : public VAction<Hop>
+{
+  Cell* cell;
+  size_t hops;
+  size_t cores;
+
+  Hop(Cell* cell, size_t hops, size_t cores)
+  : cell(cell), hops(hops), cores(cores)
+  {}
+
+  void f()
+  {
+    Scheduler::set_thread_target(1 + (cell->id + hops) % cores);
+
+    if ((hops % 5) == 0)
+      Scheduler::set_adaptive_threads((hops % 10) == 0);
+
+    if ((hops % 7) == 0)
+      Scheduler::want_ld();
+
+    if (hops > 0)
+      Cown::schedule<Hop>(cell->next, cell->next, hops - 1, cores);
+  }
+};
+
+/**
+ * A cown that keeps sending itself messages is running when the thread
+ * target drops to one. Whichever thread was running it, every later step
+ * must run on the one active thread: a retired thread hands the cown on
+ * rather than running it again.
+ **/
+struct Spinner : public VCown<Spinner>
+{
+  size_t retired_steps = 0;
+};
+
+struct Spin : public VAction<Spin>
+{
+  Spinner* s;
+  size_t steps;
+
+  Spin(Spinner* s, size_t steps) : s(s), steps(steps) {}
+
+  void f()
+  {
+    if (Scheduler::debug_is_retired())
+      s->retired_steps++;
+
+    if (steps > 0)
+    {
+      Cown::schedule<Spin>(s, s, steps - 1);
+      return;
+    }
+
+    check(Scheduler::get_thread_target() == 1);
+    check(s->retired_steps == 0);
+  }
+};
+
+struct Shrink : public VAction<Shrink>
+{
+  Spinner* s;
+  size_t steps;
+
+  Shrink(Spinner* s, size_t steps) : s(s), steps(steps) {}
+
+  void f()
+  {
+    Scheduler::set_thread_target(1);
+    Cown::schedule<Spin>(s, s, steps);
+  }
+};
+
+void test_retire_busy(size_t steps)
+{
+  auto* alloc = ThreadAlloc::get();
+  Scheduler::set_thread_target(0);
+  Scheduler::set_adaptive_threads(false);
+
+  auto s = new Spinner;
+  Cown::schedule<Shrink>(s, s, steps);
+  Cown::release(alloc, s);
+}
+
+void test_resize(size_t cores, size_t ring, size_t chains, size_t hops)
+{
+  auto* alloc = ThreadAlloc::get();
+  Scheduler::set_thread_target(0);
+  Scheduler::set_adaptive_threads(false);
+
+  Cell* first = new Cell(0);
+  Cell* last = first;
+  for (size_t i = 1; i < ring; i++)
+  {
+    last->next = new Cell(i);
+    last = last->next;
+  }
+
+  // Close the ring. Each cell holds the only reference to the next one.
+  Cown::acquire(first);
+  last->next = first;
+
+  Cell* c = first;
+  for (size_t i = 0; i < chains; i++)
+  {
+    Cown::schedule<Hop>(c, c, hops, cores);
+    c = c->next;
+  }
+
+  Cown::release(alloc, first);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness harness(argc, argv);
+
+  size_t ring = harness.opt.is<size_t>("--ring", 8);
+  size_t chains = harness.opt.is<size_t>("--chains", 4);
+  size_t hops = harness.opt.is<size_t>("--hops", 50);
+
+  harness.run(test_resize, harness.cores, ring, chains, hops);
+  harness.run(test_retire_busy, hops);
+
+  Scheduler::set_thread_target(0);
+  Scheduler::set_adaptive_threads(false);
+  return 0;
+}
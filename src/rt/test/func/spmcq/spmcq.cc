@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+#include <thread>
+
+/**
+ * Several thieves take batches from one owner's queue with `dequeue_batch`,
+ * while the owner keeps adding to the back and taking from the front, and
+ * the thieves push some elements back with `enqueue_front`. Every element
+ * must be taken exactly once.
+ **/
+struct Item
+{
+  static constexpr auto NO_EPOCH_SET = (std::numeric_limits<uint64_t>::max)();
+
+  std::atomic<Item*> next_in_queue{nullptr};
+  uint64_t epoch_when_popped = NO_EPOCH_SET;
+  std::atomic<size_t> taken{0};
+
+  void dealloc(Alloc*) {}
+};
+
+static constexpr size_t items = 100'000;
+static constexpr size_t thieves = 4;
+static constexpr size_t max_batch = 16;
+
+static Item pool[items];
+static Item token;
+static std::atomic<size_t> consumed{0};
+// Only the owner may add to the back, so a thief hands a token back here.
+static std::atomic<Item*> stolen_token{nullptr};
+
+static bool is_token(Item* i)
+{
+  return ((uintptr_t)i & 1) != 0;
+}
+
+static void take(Item* i)
+{
+  check(i->taken.fetch_add(1) == 0);
+  consumed++;
+}
+
+static void thief(SPMCQ<Item>* q, size_t id)
+{
+  auto* alloc = ThreadAlloc::get();
+  size_t round = 0;
+
+  while (consumed < items)
+  {
+    round++;
+    Item* rest;
+    Item* last;
+    Item* i = q->dequeue_batch(alloc, rest, last, max_batch);
+
+    if (i == nullptr)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    if (is_token(i))
+    {
+      check(rest == nullptr);
+      stolen_token = i;
+      continue;
+    }
+
+    // Put the odd element back, so that the front goes through the same
+    // pointers more than once.
+    if ((rest == nullptr) && ((round + id) % 7 == 0))
+    {
+      q->enqueue_front(alloc, i);
+      continue;
+    }
+
+    take(i);
+    for (Item* r = rest; r != nullptr; r = r->next_in_queue)
+    {
+      check(!is_token(r));
+      take(r);
+      if (r == last)
+        break;
+    }
+  }
+}
+
+void test_batch_stealing()
+{
+  auto* alloc = ThreadAlloc::get();
+  SPMCQ<Item> q(&token);
+
+  std::vector<std::thread> ts;
+  for (size_t i = 0; i < thieves; i++)
+    ts.emplace_back(thief, &q, i);
+
+  size_t next = 0;
+  while (consumed < items)
+  {
+    // Add a burst to the back, then take one from the front, as the owning
+    // scheduler thread does.
+    for (size_t i = 0; (i < 64) && (next < items); i++)
+      q.enqueue(alloc, &pool[next++]);
+
+    Item* t = stolen_token.exchange(nullptr);
+    if (t != nullptr)
+      q.enqueue(alloc, t);
+
+    Item* i = q.dequeue(alloc);
+    if (i == nullptr)
+      continue;
+
+    if (is_token(i))
+      q.enqueue(alloc, i);
+    else
+      take(i);
+  }
+
+  for (auto& t : ts)
+    t.join();
+
+  check(next == items);
+  for (auto& i : pool)
+    check(i.taken == 1);
+}
+
+int main()
+{
+#ifdef USE_SYSTEMATIC_TESTING
+  std::cout << "This test does not make sense to run systematically."
+            << std::endl;
+#else
+  test_batch_stealing();
+  puts("done");
+#endif
+  return 0;
+}
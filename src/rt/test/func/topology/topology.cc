@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/harness.h>
+
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/**
+ * Feeds the topology code canned CPU lists, and a canned sysfs tree for a
+ * machine with two packages on two NUMA nodes, each with two cores of two
+ * hyperthreads. The hyperthreads of core n are CPUs n and n + 4.
+ **/
+std::vector<size_t> parse(const char* list)
+{
+  std::vector<size_t> ids;
+  Topology::parse_cpulist(list, [&ids](size_t id) { ids.push_back(id); });
+  return ids;
+}
+
+void test_parse()
+{
+  check((parse("0-3,8,10-11\n") == std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+  check((parse("5") == std::vector<size_t>{5}));
+  check((parse("0,4") == std::vector<size_t>{0, 4}));
+  check(parse("").empty());
+  check(parse("\n").empty());
+}
+
+#if defined(__linux__)
+struct FakeSysfs
+{
+  std::string root;
+  std::vector<std::string> made;
+
+  FakeSysfs()
+  {
+    char dir[] = "/tmp/verona-topology-XXXXXX";
+    check(mkdtemp(dir) != nullptr);
+    root = dir;
+
+    for (size_t cpu = 0; cpu < 8; cpu++)
+    {
+      std::string topology = "/cpu/cpu" + std::to_string(cpu) + "/topology";
+      size_t core = cpu % 4;
+      write(
+        topology + "/physical_package_id", std::to_string(core / 2) + "\n");
+      write(
+        topology + "/thread_siblings_list",
+        std::to_string(core) + "," + std::to_string(core + 4) + "\n");
+    }
+
+    write("/node/node0/cpulist", "0-1,4-5\n");
+    write("/node/node1/cpulist", "2-3,6-7\n");
+  }
+
+  ~FakeSysfs()
+  {
+    for (auto it = made.rbegin(); it != made.rend(); ++it)
+      remove(it->c_str());
+
+    remove(root.c_str());
+  }
+
+  void write(const std::string& file, const std::string& contents)
+  {
+    // Make each missing directory on the way.
+    for (size_t i = 1; i < file.size(); i++)
+    {
+      if (file[i] != '/')
+        continue;
+
+      std::string dir = root + file.substr(0, i);
+      if (mkdir(dir.c_str(), 0700) == 0)
+        made.push_back(dir);
+    }
+
+    std::string path = root + file;
+    FILE* f = fopen(path.c_str(), "w");
+    check(f != nullptr);
+    fputs(contents.c_str(), f);
+    fclose(f);
+    made.push_back(path);
+  }
+};
+
+std::vector<size_t> order(Topology& t)
+{
+  std::vector<size_t> ids;
+  for (size_t i = 0; i < t.size(); i++)
+    ids.push_back(t.get(i));
+  return ids;
+}
+
+void test_layout()
+{
+  FakeSysfs sysfs;
+  std::vector<size_t> all{0, 1, 2, 3, 4, 5, 6, 7};
+  Topology t;
+
+  // Physical cores first, one package after the other.
+  t.debug_acquire(Placement::Compact, all, sysfs.root.c_str());
+  check((order(t) == std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7}));
+  check(t.distance(0, 4) == Distance::Sibling);
+  check(t.distance(0, 1) == Distance::Package);
+  check(t.distance(0, 2) == Distance::Remote);
+
+  // Physical cores first, alternating between packages.
+  t.debug_acquire(Placement::Scatter, all, sysfs.root.c_str());
+  check((order(t) == std::vector<size_t>{0, 2, 1, 3, 4, 6, 5, 7}));
+  check(t.distance(0, 1) == Distance::Remote);
+  check(t.distance(0, 2) == Distance::Package);
+
+  // A sibling outside our affinity mask does not make a CPU a hyperthread.
+  t.debug_acquire(Placement::Compact, {4, 5, 2}, sysfs.root.c_str());
+  check((order(t) == std::vector<size_t>{4, 5, 2}));
+
+  // Without sysfs, every CPU is its own core in one package.
+  t.debug_acquire(Placement::Scatter, {3, 1, 2}, "/nonexistent");
+  check((order(t) == std::vector<size_t>{1, 2, 3}));
+  check(t.distance(0, 1) == Distance::Package);
+}
+#endif
+
+int main()
+{
+  test_parse();
+#if defined(__linux__)
+  test_layout();
+#endif
+  return 0;
+}
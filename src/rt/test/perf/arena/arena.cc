@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <iomanip>
+#include <iostream>
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <vector>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Allocation throughput and memory footprint of arena regions. Lots of small
+ * regions, as used for per-request scratch space, should only hold on to a
+ * little more memory than their objects need, while large regions should
+ * still allocate quickly.
+ **/
+struct Node : public V<Node, RegionType::Arena>
+{
+  Node* next = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+void test_small_regions(size_t regions, size_t objects)
+{
+  auto* alloc = ThreadAlloc::get();
+  std::vector<Node*> roots;
+  roots.reserve(regions);
+
+  DO_TIME(
+    "Alloc " << std::setw(8) << regions << " regions of " << std::setw(8)
+             << objects << " objects",
+    {
+      for (size_t i = 0; i < regions; i++)
+      {
+        Node* root = new (alloc) Node;
+        for (size_t j = 1; j < objects; j++)
+          root->next = new (alloc, root) Node;
+        roots.push_back(root);
+      }
+    });
+
+  size_t memory = 0;
+  for (auto root : roots)
+    memory += RegionArena::debug_arena_memory(root);
+
+  std::cout << "  arena memory per region: " << (memory / regions)
+            << " bytes, for " << (objects * sizeof(Node)) << " bytes of objects"
+            << std::endl;
+
+  DO_TIME("Release " << std::setw(8) << regions << " regions", {
+    for (auto root : roots)
+      Region::release(alloc, root);
+  });
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t regions = opt.is<size_t>("--regions", 100000);
+  size_t large = opt.is<size_t>("--large", 1000000);
+
+  test_small_regions(regions, 1);
+  test_small_regions(regions, 16);
+  test_small_regions(regions / 100, 1000);
+  test_small_regions(10, large);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * A fast producer floods a slow consumer, either from an external thread or
+ * from another cown. Reports the largest number of messages that were queued
+ * on the consumer at once, which is bounded when back-pressure is enabled.
+ **/
+static std::atomic<size_t> backlog = 0;
+static std::atomic<size_t> max_backlog = 0;
+
+static void sent()
+{
+  size_t b = ++backlog;
+  size_t m = max_backlog.load(std::memory_order_relaxed);
+  while ((b > m) && !max_backlog.compare_exchange_weak(m, b))
+  {}
+}
+
+struct Consumer : public VCown<Consumer>
+{};
+
+struct Consume : public VAction<Consume>
+{
+  size_t work;
+
+  Consume(size_t work) : work(work) {}
+
+  void f()
+  {
+    volatile size_t sum = 0;
+    for (size_t i = 0; i < work; i++)
+      sum = sum + i;
+
+    backlog--;
+  }
+};
+
+struct Producer : public VCown<Producer>
+{
+  Consumer* consumer;
+  size_t remaining;
+  size_t work;
+
+  Producer(Consumer* consumer, size_t remaining, size_t work)
+  : consumer(consumer), remaining(remaining), work(work)
+  {}
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(consumer);
+  }
+};
+
+struct Produce : public VAction<Produce>
+{
+  Producer* p;
+
+  Produce(Producer* p) : p(p) {}
+
+  void f()
+  {
+    // Send in bursts, so that muting has a chance to take effect.
+    for (size_t i = 0; (i < 1000) && (p->remaining > 0); i++)
+    {
+      sent();
+      Cown::schedule<Consume>(p->consumer, p->work);
+      p->remaining--;
+    }
+
+    if (p->remaining > 0)
+      Cown::schedule<Produce>(p, p);
+    else
+      Cown::release(ThreadAlloc::get(), p);
+  }
+};
+
+void test_flood(
+  size_t cores, size_t count, size_t work, bool external, bool back_pressure)
+{
+  Scheduler& sched = Scheduler::get();
+  Scheduler::set_back_pressure(back_pressure);
+  backlog = 0;
+  max_backlog = 0;
+
+  DO_TIME(
+    (external ? "External" : "Cown    ") << " flood, back-pressure "
+                                         << back_pressure,
+    {
+      sched.init(cores);
+      auto c = new Consumer;
+
+      std::thread thr;
+      if (external)
+      {
+        Scheduler::set_allow_teardown(false);
+        thr = std::thread([=]() {
+          for (size_t i = 0; i < count; i++)
+          {
+            sent();
+            Cown::schedule<Consume>(c, work);
+          }
+
+          Cown::release(ThreadAlloc::get(), c);
+          Scheduler::set_allow_teardown(true);
+        });
+      }
+      else
+      {
+        auto p = new Producer(c, count, work);
+        Cown::schedule<Produce>(p, p);
+      }
+
+      sched.run();
+
+      if (external)
+        thr.join();
+    });
+
+  std::cout << "  Largest backlog: " << max_backlog << " messages"
+            << std::endl;
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 4);
+  size_t count = opt.is<size_t>("--count", 1000000);
+  size_t work = opt.is<size_t>("--work", 1000);
+
+  for (bool external : {true, false})
+  {
+    test_flood(cores, count, work, external, false);
+    test_flood(cores, count, work, external, true);
+  }
+
+  return 0;
+}
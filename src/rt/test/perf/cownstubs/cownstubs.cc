@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <vector>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Churn of short-lived cowns next to a large number of long-lived ones. Each
+ * round creates a batch of cowns, runs a behaviour on each, and drops them,
+ * so their stubs are collected while the long-lived cowns are still owned by
+ * the same scheduler threads. Collecting the stubs should only cost in
+ * proportion to the number of cowns freed, not to the number owned.
+ **/
+struct Cell : public VCown<Cell>
+{};
+
+struct Touch : public VAction<Touch>
+{
+  void f() {}
+};
+
+struct Holder : public VCown<Holder>
+{
+  std::vector<Cell*> cells;
+};
+
+struct Populate : public VAction<Populate>
+{
+  Holder* h;
+  size_t live;
+
+  Populate(Holder* h, size_t live) : h(h), live(live) {}
+
+  void f()
+  {
+    h->cells.reserve(live);
+    for (size_t i = 0; i < live; i++)
+      h->cells.push_back(new Cell);
+  }
+};
+
+struct Churn : public VAction<Churn>
+{
+  Holder* h;
+  size_t churn;
+  size_t rounds;
+
+  Churn(Holder* h, size_t churn, size_t rounds)
+  : h(h), churn(churn), rounds(rounds)
+  {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    for (size_t i = 0; i < churn; i++)
+    {
+      auto c = new Cell;
+      Cown::schedule<Touch>(c);
+      Cown::release(alloc, c);
+    }
+
+    if (rounds > 1)
+    {
+      Cown::schedule<Churn>(h, h, churn, rounds - 1);
+      return;
+    }
+
+    for (auto c : h->cells)
+      Cown::release(alloc, c);
+    h->cells.clear();
+  }
+};
+
+void test_churn(size_t cores, size_t live, size_t churn, size_t rounds)
+{
+  Scheduler& sched = Scheduler::get();
+
+  DO_TIME(
+    rounds << " rounds of " << churn << " cowns next to " << live
+           << " long-lived cowns",
+    {
+      sched.init(cores);
+
+      auto* alloc = ThreadAlloc::get();
+      auto h = new Holder;
+      Cown::schedule<Populate>(h, h, live);
+      Cown::schedule<Churn>(h, h, churn, rounds);
+      Cown::release(alloc, h);
+
+      sched.run();
+    });
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 4);
+  size_t live = opt.is<size_t>("--live", 2000000);
+  size_t churn = opt.is<size_t>("--churn", 1000);
+  size_t rounds = opt.is<size_t>("--rounds", 1000);
+
+  test_churn(cores, 0, churn, rounds);
+  test_churn(cores, live, churn, rounds);
+  return 0;
+}
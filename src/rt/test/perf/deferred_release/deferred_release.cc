@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <chrono>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * A few cowns each repeatedly build a large region and drop it. Reports how
+ * long dropping the region holds up the behaviour, and the total run time,
+ * with the region released in place or left to idle threads.
+ **/
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+  Node* sub = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (sub != nullptr)
+      st->push(sub);
+  }
+
+  void trace_possibly_iso(ObjectStack* st) const
+  {
+    trace(st);
+  }
+};
+
+struct Stall
+{
+  std::atomic<uint64_t> total = 0;
+  std::atomic<uint64_t> worst = 0;
+};
+
+struct Builder : public VCown<Builder>
+{
+  size_t rounds;
+  size_t objects;
+  Stall* stall;
+
+  Builder(size_t rounds, size_t objects, Stall* stall)
+  : rounds(rounds), objects(objects), stall(stall)
+  {}
+};
+
+struct Build : public VAction<Build>
+{
+  Builder* b;
+
+  Build(Builder* b) : b(b) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    // Hang several subregions off the region, so that releasing it can be
+    // split between threads.
+    Node* root = new (alloc) Node;
+    for (size_t i = 0; i < b->objects; i++)
+    {
+      Node* n = new (alloc, root) Node;
+      n->next = root->next;
+      root->next = n;
+
+      if (i < 8)
+      {
+        n->sub = new (alloc) Node;
+        for (size_t j = 0; j < b->objects; j++)
+        {
+          Node* m = new (alloc, n->sub) Node;
+          m->next = n->sub->next;
+          n->sub->next = m;
+        }
+      }
+    }
+
+    uint64_t start = Aal::tick();
+    Region::release(alloc, root);
+    uint64_t elapsed = Aal::tick() - start;
+
+    b->stall->total += elapsed;
+    uint64_t worst = b->stall->worst;
+    while ((elapsed > worst) &&
+           !b->stall->worst.compare_exchange_weak(worst, elapsed))
+    {}
+
+    if (--b->rounds > 0)
+      Cown::schedule<Build>(b, b);
+  }
+};
+
+void test_release(
+  size_t cores, size_t builders, size_t rounds, size_t objects, bool deferred)
+{
+  Scheduler& sched = Scheduler::get();
+  DeferredRelease::set_deferred_release(deferred, 64 * 1024);
+
+  sched.init(cores);
+
+  Stall stall;
+  for (size_t i = 0; i < builders; i++)
+  {
+    auto b = new Builder(rounds, objects, &stall);
+    Cown::schedule<Build>(b, b);
+    Cown::release(ThreadAlloc::get(), b);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  sched.run();
+  auto end = std::chrono::steady_clock::now();
+
+  auto stats = DeferredRelease::get_stats();
+  double wall = std::chrono::duration<double>(end - start).count();
+
+  std::cout << (deferred ? "Deferred" : "In place") << ": "
+            << "mean stall " << (stall.total / (builders * rounds))
+            << " cycles, worst " << stall.worst << " cycles, "
+            << "total " << wall << " s, "
+            << "most queued " << stats.max_queued_bytes << " bytes"
+            << std::endl;
+
+  DeferredRelease::set_deferred_release(false);
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 8);
+  size_t builders = opt.is<size_t>("--builders", 2);
+  size_t rounds = opt.is<size_t>("--rounds", 50);
+  size_t objects = opt.is<size_t>("--objects", 20000);
+
+  test_release(cores, builders, rounds, objects, false);
+  test_release(cores, builders, rounds, objects, true);
+  return 0;
+}
@@ -2,11 +2,17 @@
 // Licensed under the MIT License.
 #include <test/measuretime.h>
 #include <test/opt.h>
+#include <thread>
 #include <verona.h>
 
 using namespace snmalloc;
 using namespace verona::rt;
 
+struct Value : public V<Value>
+{
+  void trace(ObjectStack*) const {}
+};
+
 void test_epoch()
 {
   // Used to prevent malloc from being optimised away.
@@ -47,8 +53,89 @@ void test_epoch()
   (void)old;
 }
 
-int main(int, char**)
+/**
+ * Replaces a value `count` times, deferring the decref of the old value as
+ * Noticeboard::update does, and reports how much was left waiting in the
+ * epoch. With `straggler`, another thread has used the epoch once and not
+ * come back, so the epoch can only advance once that thread is ejected.
+ **/
+void test_sustained_updates(size_t count, bool straggler)
 {
+  auto* alloc = ThreadAlloc::get();
+  std::atomic<bool> joined = false;
+  std::atomic<bool> done = false;
+  std::thread other;
+
+  if (straggler)
+  {
+    other = std::thread([&joined, &done]() {
+      {
+        Epoch e(ThreadAlloc::get());
+      }
+      joined = true;
+
+      while (!done)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    while (!joined)
+      std::this_thread::yield();
+  }
+
+  auto before = Epoch::get_stats();
+
+  Value* current = new (alloc) Value;
+  Freeze::apply(alloc, current);
+
+  DO_TIME(
+    "updates " << (straggler ? "straggler" : "alone    ") << " " << count, {
+      for (size_t n = 0; n < count; n++)
+      {
+        Value* next = new (alloc) Value;
+        Freeze::apply(alloc, next);
+
+        Epoch e(alloc);
+        e.dec_in_epoch(current);
+        current = next;
+      }
+    });
+
+  auto after = Epoch::get_stats();
+  size_t waits = after.waits - before.waits;
+
+  std::cout << "  advances: " << (after.advances - before.advances)
+            << "  forced: " << (after.forced - before.forced)
+            << "  backlog: " << after.backlog
+            << "  max backlog: " << after.max_backlog << " (cap "
+            << Epoch::get_max_backlog() << ")"
+            << "  mean advance cycles: "
+            << ((waits == 0) ?
+                  0 :
+                  (after.advance_cycles - before.advance_cycles) / waits)
+            << "  max advance cycles: " << after.max_advance_cycles
+            << std::endl;
+
+  Immutable::release(alloc, current);
+
+  done = true;
+  if (straggler)
+    other.join();
+
+  Epoch::flush(alloc);
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+  size_t updates = opt.is<size_t>("--updates", 1000000);
+  size_t cap = opt.is<size_t>("--cap", Epoch::get_max_backlog());
+
+  Epoch::set_max_backlog(cap);
+
   test_epoch();
+  test_sustained_updates(updates, false);
+  test_sustained_updates(updates, true);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
   return 0;
 }
@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * A single behaviour schedules lots of small behaviours on fresh cowns, which
+ * all land in the queue of one scheduler thread. The other threads can only
+ * get work by stealing it, so this measures how quickly a fan-out is spread
+ * across the pool.
+ **/
+struct Worker : public VCown<Worker>
+{};
+
+struct Work : public VAction<Work>
+{
+  size_t work;
+
+  Work(size_t work) : work(work) {}
+
+  void f()
+  {
+    volatile size_t sum = 0;
+    for (size_t i = 0; i < work; i++)
+      sum = sum + i;
+  }
+};
+
+struct Spawner : public VCown<Spawner>
+{};
+
+struct Spawn : public VAction<Spawn>
+{
+  size_t count;
+  size_t work;
+
+  Spawn(size_t count, size_t work) : count(count), work(work) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    for (size_t i = 0; i < count; i++)
+    {
+      auto w = new Worker;
+      Cown::schedule<Work>(w, work);
+      Cown::release(alloc, w);
+    }
+  }
+};
+
+void test_fanout(size_t cores, size_t count, size_t work, size_t steal_batch)
+{
+  Scheduler& sched = Scheduler::get();
+  Scheduler::set_steal_batch(steal_batch);
+
+  DO_TIME("Fan-out, steal batch " << steal_batch, {
+    sched.init(cores);
+
+    auto* alloc = ThreadAlloc::get();
+    auto s = new Spawner;
+    Cown::schedule<Spawn>(s, count, work);
+    Cown::release(alloc, s);
+
+    sched.run();
+  });
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 4);
+  size_t count = opt.is<size_t>("--count", 1000000);
+  size_t work = opt.is<size_t>("--work", 100);
+
+  // One cown per steal, as before batch stealing, against the default.
+  test_fanout(cores, count, work, 1);
+  test_fanout(cores, count, work, 32);
+  return 0;
+}
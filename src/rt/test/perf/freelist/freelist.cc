@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <iomanip>
+#include <iostream>
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Allocation churn in a trace region, without and then with region-local
+ * free lists. Each round allocates a batch of short-lived objects of a few
+ * sizes next to a live list, and collects the region, so that later rounds
+ * can recycle what earlier rounds swept.
+ **/
+template<size_t N>
+struct Node : public V<Node<N>>
+{
+  Object* next = nullptr;
+  uint8_t payload[N];
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+using Small = Node<8>;
+using Medium = Node<96>;
+using Large = Node<480>;
+
+void test_churn(size_t live, size_t garbage, size_t rounds, bool free_lists)
+{
+  auto* alloc = ThreadAlloc::get();
+  RegionTrace::set_free_lists(free_lists);
+
+  auto* root = new (alloc) Small;
+  for (size_t i = 0; i < live; i++)
+  {
+    auto* n = new (alloc, root) Small;
+    n->next = root->next;
+    root->next = n;
+  }
+
+  DO_TIME(
+    "Free lists " << (free_lists ? "on: " : "off:") << std::setw(6) << rounds
+                  << " rounds of " << std::setw(7) << garbage << " objects",
+    {
+      for (size_t r = 0; r < rounds; r++)
+      {
+        for (size_t i = 0; i < garbage; i++)
+        {
+          switch (i % 3)
+          {
+            case 0:
+              new (alloc, root) Small;
+              break;
+            case 1:
+              new (alloc, root) Medium;
+              break;
+            default:
+              new (alloc, root) Large;
+              break;
+          }
+        }
+
+        RegionTrace::gc(alloc, root);
+      }
+    });
+
+  std::cout << "  reused " << RegionTrace::get_gc_stats(root).reused_bytes
+            << " bytes, keeping "
+            << RegionTrace::debug_free_list_memory(root) << " bytes"
+            << std::endl;
+
+  Region::release(alloc, root);
+  RegionTrace::set_free_lists(false);
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t live = opt.is<size_t>("--live", 1000);
+  size_t garbage = opt.is<size_t>("--garbage", 1000);
+  size_t rounds = opt.is<size_t>("--rounds", 1000);
+
+  test_churn(live, garbage, rounds, false);
+  test_churn(live, garbage, rounds, true);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <iomanip>
+#include <iostream>
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Collection time for a trace region with a large, stable core, with and
+ * without generational collection. Each round allocates a batch of
+ * short-lived objects, keeps a few of them by storing them into the core
+ * through the write barrier, and collects the region.
+ **/
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+  Node* other = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (other != nullptr)
+      st->push(other);
+  }
+};
+
+void test_collect(
+  size_t live, size_t garbage, size_t keep, size_t rounds, bool generational)
+{
+  auto* alloc = ThreadAlloc::get();
+  RegionTrace::set_generational(generational);
+
+  Node* root = new (alloc) Node;
+  for (size_t i = 0; i < live; i++)
+  {
+    Node* n = new (alloc, root) Node;
+    n->next = root->next;
+    root->next = n;
+  }
+
+  Node* core = root->next;
+
+  DO_TIME(
+    (generational ? "Generational:" : "Full:        ") << std::setw(6)
+      << rounds << " rounds of " << std::setw(6) << garbage
+      << " objects next to " << std::setw(8) << live << " live objects",
+    {
+      for (size_t r = 0; r < rounds; r++)
+      {
+        for (size_t i = 0; i < garbage; i++)
+        {
+          Node* n = new (alloc, root) Node;
+
+          if (i < keep)
+          {
+            // Replace the survivor of an earlier round, which becomes
+            // garbage for a major collection.
+            core->other = n;
+            RegionTrace::write_barrier(alloc, root, core);
+            core = (core->next != nullptr) ? core->next : root->next;
+          }
+        }
+
+        RegionTrace::gc(alloc, root);
+      }
+    });
+
+  auto& stats = RegionTrace::get_gc_stats(root);
+  std::cout << "  " << stats.minor_collections << " of " << stats.collections
+            << " collections were minor" << std::endl;
+
+  Region::release(alloc, root);
+  RegionTrace::set_generational(false);
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t live = opt.is<size_t>("--live", 100000);
+  size_t garbage = opt.is<size_t>("--garbage", 1000);
+  size_t keep = opt.is<size_t>("--keep", 10);
+  size_t rounds = opt.is<size_t>("--rounds", 1000);
+
+  test_collect(live, garbage, keep, rounds, false);
+  test_collect(live, garbage, keep, rounds, true);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <chrono>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Many worker cowns repeatedly take and drop references to one shared
+ * immutable and one shared cown. Reports the run time with the references
+ * counted directly on the shared objects, which every core contends on, and
+ * with `Epoch::acquire_hot` and `Epoch::release_hot`, which count them in a
+ * per-thread reserve.
+ **/
+struct Value : public V<Value>
+{
+  size_t value = 1;
+
+  void trace(ObjectStack*) const {}
+};
+
+struct Shared : public VCown<Shared>
+{};
+
+struct Worker : public VCown<Worker>
+{
+  Value* value;
+  Shared* shared;
+  size_t rounds;
+  size_t ops;
+  bool hot;
+  size_t sum = 0;
+
+  Worker(Value* value, Shared* shared, size_t rounds, size_t ops, bool hot)
+  : value(value), shared(shared), rounds(rounds), ops(ops), hot(hot)
+  {
+    Immutable::acquire(value);
+    Cown::acquire(shared);
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(value);
+    fields->push(shared);
+  }
+};
+
+struct Work : public VAction<Work>
+{
+  Worker* worker;
+
+  Work(Worker* worker) : worker(worker) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    auto* value = worker->value;
+    auto* shared = worker->shared;
+
+    if (worker->hot)
+    {
+      Epoch e(alloc);
+
+      for (size_t i = 0; i < worker->ops; i++)
+      {
+        e.acquire_hot(value);
+        e.acquire_hot(shared);
+        worker->sum += value->value;
+        e.release_hot(shared);
+        e.release_hot(value);
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < worker->ops; i++)
+      {
+        Immutable::acquire(value);
+        Cown::acquire(shared);
+        worker->sum += value->value;
+        Cown::release(alloc, shared);
+        Immutable::release(alloc, value);
+      }
+    }
+
+    if (--worker->rounds > 0)
+      Cown::schedule<Work>(worker, worker);
+  }
+};
+
+void test_workers(
+  size_t cores, size_t workers, size_t rounds, size_t ops, bool hot)
+{
+  Scheduler& sched = Scheduler::get();
+  sched.init(cores);
+
+  auto* alloc = ThreadAlloc::get();
+  Value* value = new (alloc) Value;
+  Freeze::apply(alloc, value);
+  Shared* shared = new Shared;
+
+  for (size_t i = 0; i < workers; i++)
+  {
+    auto w = new Worker(value, shared, rounds, ops, hot);
+    Cown::schedule<Work>(w, w);
+    Cown::release(alloc, w);
+  }
+  Immutable::release(alloc, value);
+  Cown::release(alloc, shared);
+
+  auto start = std::chrono::steady_clock::now();
+  sched.run();
+  auto end = std::chrono::steady_clock::now();
+
+  double wall = std::chrono::duration<double>(end - start).count();
+  double total = (double)(workers * rounds * ops);
+
+  std::cout << (hot ? "Hot  " : "Plain") << ": " << wall << " s, "
+            << (total / wall) << " ops/s" << std::endl;
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 8);
+  size_t workers = opt.is<size_t>("--workers", 256);
+  size_t rounds = opt.is<size_t>("--rounds", 100);
+  size_t ops = opt.is<size_t>("--ops", 1000);
+
+  test_workers(cores, workers, rounds, ops, false);
+  test_workers(cores, workers, rounds, ops, true);
+  return 0;
+}
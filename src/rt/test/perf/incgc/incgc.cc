@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <iomanip>
+#include <iostream>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Pause times for automatic collection of a large trace region, with the
+ * sweep done in one go or in slices. Each round allocates a batch of garbage
+ * next to a large live list, and then runs the collection work due at that
+ * safe point. Prints a histogram of pauses in powers of two of cycles.
+ **/
+struct Node : public V<Node>
+{
+  Node* next = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+static constexpr size_t BUCKETS = 32;
+
+void test_pauses(size_t live, size_t garbage, size_t rounds, size_t slice)
+{
+  auto* alloc = ThreadAlloc::get();
+  RegionTrace::set_auto_gc(true, 200, 4096);
+  RegionTrace::set_incremental_gc(slice);
+
+  Node* root = new Node;
+  for (size_t i = 0; i < live; i++)
+  {
+    Node* n = new (alloc, root) Node;
+    n->next = root->next;
+    root->next = n;
+  }
+
+  size_t histogram[BUCKETS] = {};
+  uint64_t total = 0;
+  uint64_t worst = 0;
+  size_t pauses = 0;
+
+  for (size_t r = 0; r < rounds; r++)
+  {
+    for (size_t i = 0; i < garbage; i++)
+      new (alloc, root) Node;
+
+    uint64_t pause = RegionTrace::gc_if_grown(alloc, root);
+    if (pause == 0)
+      continue;
+
+    size_t bucket = 0;
+    while ((bucket + 1 < BUCKETS) && (pause >= ((uint64_t)1 << (bucket + 1))))
+      bucket++;
+
+    histogram[bucket]++;
+    total += pause;
+    worst = std::max(worst, pause);
+    pauses++;
+  }
+
+  std::cout << "Slice " << std::setw(6) << slice << ": " << pauses
+            << " pauses, mean " << (pauses == 0 ? 0 : total / pauses)
+            << " cycles, worst " << worst << " cycles" << std::endl;
+
+  for (size_t i = 0; i < BUCKETS; i++)
+  {
+    if (histogram[i] != 0)
+      std::cout << "  <2^" << std::setw(2) << (i + 1) << " cycles: "
+                << histogram[i] << std::endl;
+  }
+
+  Region::release(alloc, root);
+  RegionTrace::set_incremental_gc(0);
+  RegionTrace::set_auto_gc(false);
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t live = opt.is<size_t>("--live", 100000);
+  size_t garbage = opt.is<size_t>("--garbage", 1000);
+  size_t rounds = opt.is<size_t>("--rounds", 10000);
+
+  test_pauses(live, garbage, rounds, 0);
+  test_pauses(live, garbage, rounds, 10000);
+  test_pauses(live, garbage, rounds, 1000);
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
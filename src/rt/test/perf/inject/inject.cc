@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <thread>
+#include <vector>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Threads outside the pool submit lots of small behaviours on a set of cowns,
+ * as an I/O thread would. Compares the injection queue with placing cowns
+ * directly on the scheduler threads' queues.
+ **/
+struct Target : public VCown<Target>
+{};
+
+struct Work : public VAction<Work>
+{
+  void f() {}
+};
+
+void test_inject(
+  size_t cores, size_t producers, size_t cowns, size_t count, bool inject)
+{
+  Scheduler& sched = Scheduler::get();
+  Scheduler::set_inject_external(inject);
+
+  DO_TIME(
+    (inject ? "Injection queue" : "Round robin    ")
+      << " " << producers << " producers, " << count << " behaviours each",
+    {
+      sched.init(cores);
+      Scheduler::set_allow_teardown(false);
+
+      std::vector<Cown*> targets;
+      for (size_t i = 0; i < cowns; i++)
+        targets.push_back(new Target);
+
+      std::atomic<size_t> finished = 0;
+      std::vector<std::thread> threads;
+      for (size_t p = 0; p < producers; p++)
+      {
+        threads.emplace_back([&, p]() {
+          for (size_t i = 0; i < count; i++)
+            Cown::schedule<Work>(targets[(i + p) % cowns]);
+
+          if (++finished == producers)
+          {
+            for (auto t : targets)
+              Cown::release(ThreadAlloc::get(), t);
+
+            Scheduler::set_allow_teardown(true);
+          }
+        });
+      }
+
+      sched.run();
+
+      for (auto& t : threads)
+        t.join();
+    });
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 4);
+  size_t producers = opt.is<size_t>("--producers", 2);
+  size_t cowns = opt.is<size_t>("--cowns", 64);
+  size_t count = opt.is<size_t>("--count", 1000000);
+
+  test_inject(cores, producers, cowns, count, false);
+  test_inject(cores, producers, cowns, count, true);
+  return 0;
+}
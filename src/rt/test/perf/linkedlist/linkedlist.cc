@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <iostream>
 #include <test/measuretime.h>
+#include <test/opt.h>
 #include <verona.h>
 
 using namespace snmalloc;
@@ -65,8 +66,103 @@ void test_linked_list()
   snmalloc::current_alloc_pool()->debug_check_empty();
 }
 
-int main(int, char**)
+/**
+ * Builds a doubly linked list of `list_size` objects in the region of `root`.
+ **/
+C1* make_list(Alloc* alloc, C1* root, size_t list_size)
 {
+  C1* curr = root;
+
+  for (size_t i = 0; i < list_size; i++)
+  {
+    C1* next = new (alloc, root) C1;
+    curr->f1 = next;
+    next->f2 = curr;
+    curr = next;
+  }
+
+  return curr;
+}
+
+struct Runner : public VCown<Runner>
+{};
+
+/**
+ * Freezes a list, split into `segments` subregions, inside a behaviour, so
+ * that idle scheduler threads can help.
+ **/
+struct FreezeSegments : public VAction<FreezeSegments>
+{
+  size_t list_size;
+  size_t segments;
+
+  FreezeSegments(size_t list_size, size_t segments)
+  : list_size(list_size), segments(segments)
+  {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    C1* root = new (alloc) C1;
+    C1* spine = root;
+
+    for (size_t i = 0; i < segments; i++)
+    {
+      C1* segment = new (alloc) C1;
+      make_list(alloc, segment, list_size / segments);
+
+      C1* next = new (alloc, root) C1;
+      spine->f1 = next;
+      next->f2 = segment;
+      spine = next;
+    }
+
+    DO_TIME(
+      (Freeze::get_parallel_freeze() ? "Parallel" : "Serial  ")
+        << " freeze " << std::setw(3) << segments
+        << " segments: " << std::setw(10) << list_size,
+      { Freeze::apply(alloc, root); });
+
+    Immutable::release(alloc, root);
+  }
+};
+
+void test_segmented_list(size_t cores, size_t segments, bool parallel)
+{
+  // Share regions of at least 64KiB, so that every segment is shared.
+  Freeze::set_parallel_freeze(parallel, 64 * 1024);
+
+  for (size_t list_size = 100000; list_size <= 1000000; list_size += 100000)
+  {
+    Scheduler& sched = Scheduler::get();
+    sched.init(cores);
+
+    auto r = new Runner;
+    Cown::schedule<FreezeSegments>(r, list_size, segments);
+    Cown::release(ThreadAlloc::get(), r);
+
+    sched.run();
+  }
+
+  Freeze::set_parallel_freeze(false);
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 8);
+  size_t segments = opt.is<size_t>("--segments", 16);
+
   test_linked_list();
+
+  // A single list is one SCC in one region, so only finishing its objects
+  // can be shared. A list split into subregions is frozen one subregion per
+  // thread.
+  test_segmented_list(cores, 1, false);
+  test_segmented_list(cores, 1, true);
+  test_segmented_list(cores, segments, false);
+  test_segmented_list(cores, segments, true);
   return 0;
 }
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <iomanip>
+#include <iostream>
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <vector>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Merging regions of different types. Sub-results are built in small regions
+ * and merged into a long-lived region that owns them, in both directions
+ * between arena and trace regions, and between regions of the same type for
+ * comparison. Merging should not depend on the number of objects merged, and
+ * a trace region should still collect the objects in the arenas it adopts.
+ **/
+template<RegionType region_type>
+struct Node : public V<Node<region_type>, region_type>
+{
+  Object* next = nullptr;
+  Object* other = nullptr;
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+
+    if (other != nullptr)
+      st->push(other);
+  }
+};
+
+/**
+ * Builds a list of `objects` objects in a new region, and returns its root.
+ **/
+template<RegionType region_type>
+Node<region_type>* make_result(Alloc* alloc, size_t objects)
+{
+  auto* root = new (alloc) Node<region_type>;
+  for (size_t i = 1; i < objects; i++)
+  {
+    auto* n = new (alloc, root) Node<region_type>;
+    n->next = root->next;
+    root->next = n;
+  }
+  return root;
+}
+
+template<RegionType region_type>
+const char* name()
+{
+  return region_type == RegionType::Trace ? "trace" : "arena";
+}
+
+template<RegionType into_type, RegionType result_type>
+void test_merge(size_t results, size_t objects)
+{
+  using IntoClass = typename RegionType_to_class<into_type>::T;
+  auto* alloc = ThreadAlloc::get();
+
+  std::vector<Node<result_type>*> built;
+  built.reserve(results);
+
+  DO_TIME(
+    "Build " << std::setw(6) << results << " " << name<result_type>()
+             << " regions of " << std::setw(7) << objects << " objects",
+    {
+      for (size_t i = 0; i < results; i++)
+        built.push_back(make_result<result_type>(alloc, objects));
+    });
+
+  auto* into = new (alloc) Node<into_type>;
+
+  DO_TIME("Merge them into the " << name<into_type>() << " region", {
+    for (auto r : built)
+    {
+      IntoClass::merge(alloc, into, r);
+      r->other = into->other;
+      into->other = r;
+    }
+  });
+
+  if constexpr (into_type == RegionType::Trace)
+  {
+    // Drop every other result, so that a trace region has half of what it
+    // adopted to collect.
+    Object** p = &into->other;
+    while (*p != nullptr)
+    {
+      auto* r = (Node<result_type>*)*p;
+      *p = r->other;
+      if (*p != nullptr)
+        p = &((Node<result_type>*)*p)->other;
+    }
+
+    DO_TIME("Collect half of them", {
+      RegionTrace::gc(alloc, into);
+    });
+  }
+
+  DO_TIME("Release", {
+    Region::release(alloc, into);
+  });
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t results = opt.is<size_t>("--results", 1000);
+  size_t objects = opt.is<size_t>("--objects", 10000);
+
+  for (size_t n = 10; n <= objects; n *= 10)
+  {
+    test_merge<RegionType::Trace, RegionType::Arena>(results, n);
+    test_merge<RegionType::Trace, RegionType::Trace>(results, n);
+    test_merge<RegionType::Arena, RegionType::Trace>(results, n);
+    test_merge<RegionType::Arena, RegionType::Arena>(results, n);
+  }
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
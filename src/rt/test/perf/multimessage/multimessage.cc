@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <test/measuretime.h>
+#include <test/opt.h>
+#include <vector>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * A chain of short behaviours, each on two cowns, where each behaviour
+ * schedules the next. Every hop acquires two sleeping cowns, so its latency
+ * is dominated by how quickly a fully acquired multimessage starts running.
+ **/
+struct CCown : public VCown<CCown>
+{
+  size_t uses = 0;
+};
+
+static std::vector<Cown*> pool;
+
+struct Hop : public VAction<Hop>
+{
+  CCown* a;
+  CCown* b;
+  size_t remaining;
+
+  Hop(CCown* a, CCown* b, size_t remaining)
+  : a(a), b(b), remaining(remaining)
+  {}
+
+  void f()
+  {
+    a->uses++;
+    b->uses++;
+
+    if (remaining == 0)
+    {
+      // The pool holds a reference to every cown until the chain is done.
+      auto* alloc = ThreadAlloc::get();
+      for (auto c : pool)
+        Cown::release(alloc, c);
+      return;
+    }
+
+    size_t i = (remaining * 2) % pool.size();
+    Cown* next[2] = {pool[i], pool[i + 1]};
+    Cown::schedule<Hop>(
+      2, next, (CCown*)next[0], (CCown*)next[1], remaining - 1);
+  }
+
+  void trace(ObjectStack* st) const
+  {
+    st->push(a);
+    st->push(b);
+  }
+};
+
+void start_chain(size_t cowns, size_t hops)
+{
+  for (size_t i = 0; i < cowns; i++)
+    pool.push_back(new CCown);
+
+  Cown* first[2] = {pool[0], pool[1]};
+  Cown::schedule<Hop>(2, first, (CCown*)pool[0], (CCown*)pool[1], hops);
+}
+
+void test_chain(size_t cores, size_t cowns, size_t hops, size_t inline_budget)
+{
+  Scheduler& sched = Scheduler::get();
+  Scheduler::set_inline_budget(inline_budget);
+
+  DO_TIME("Chain of " << hops << " hops, inline budget " << inline_budget, {
+    sched.init(cores);
+    start_chain(cowns, hops);
+    sched.run();
+    pool.clear();
+  });
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 4);
+  size_t cowns = opt.is<size_t>("--cowns", 64);
+  size_t hops = opt.is<size_t>("--hops", 1000000);
+
+  // Pairs of cowns are taken from the pool in turn.
+  if ((cowns < 4) || ((cowns % 2) != 0))
+  {
+    std::cout << "--cowns must be even, and at least 4" << std::endl;
+    return 1;
+  }
+
+  // Always reschedule the last cown, as by default, and then hand it straight
+  // to the sending thread.
+  test_chain(cores, cowns, hops, 0);
+  test_chain(cores, cowns, hops, 8);
+  return 0;
+}
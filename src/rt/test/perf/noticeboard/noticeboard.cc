@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <chrono>
+#include <test/opt.h>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * Many reader cowns repeatedly read a table published on one noticeboard,
+ * while its owner occasionally replaces it. Reports the run time with the
+ * table read by `peek`, which takes and drops a reference to it, and by
+ * `borrow`, which does not touch its reference count.
+ **/
+struct Entry : public V<Entry>
+{
+  size_t value;
+  Entry* next = nullptr;
+
+  Entry(size_t value) : value(value) {}
+
+  void trace(ObjectStack* st) const
+  {
+    if (next != nullptr)
+      st->push(next);
+  }
+};
+
+Entry* make_table(Alloc* alloc, size_t version)
+{
+  Entry* root = new (alloc) Entry(version);
+  Entry* e = new (alloc, root) Entry(version);
+  root->next = e;
+  Freeze::apply(alloc, root);
+  return root;
+}
+
+struct Table : public VCown<Table>
+{
+  Noticeboard<Object*> board;
+  size_t updates;
+
+  Table(Object* initial, size_t updates) : board{initial}, updates(updates)
+  {}
+
+  void trace(ObjectStack* fields) const
+  {
+    board.trace(fields);
+  }
+};
+
+struct Update : public VAction<Update>
+{
+  Table* table;
+
+  Update(Table* table) : table(table) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    table->board.update(alloc, make_table(alloc, table->updates));
+
+    if (--table->updates > 0)
+      Cown::schedule<Update>(table, table);
+  }
+};
+
+struct Reader : public VCown<Reader>
+{
+  Table* table;
+  size_t rounds;
+  size_t reads;
+  bool borrow;
+  size_t sum = 0;
+
+  Reader(Table* table, size_t rounds, size_t reads, bool borrow)
+  : table(table), rounds(rounds), reads(reads), borrow(borrow)
+  {
+    Cown::acquire(table);
+  }
+
+  void trace(ObjectStack* fields) const
+  {
+    fields->push(table);
+  }
+};
+
+struct Read : public VAction<Read>
+{
+  Reader* reader;
+
+  Read(Reader* reader) : reader(reader) {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+    auto& board = reader->table->board;
+
+    for (size_t i = 0; i < reader->reads; i++)
+    {
+      if (reader->borrow)
+      {
+        auto table = board.borrow(alloc);
+        reader->sum += ((Entry*)table.get())->next->value;
+      }
+      else
+      {
+        auto table = (Entry*)board.peek(alloc);
+        reader->sum += table->next->value;
+        Immutable::release(alloc, table);
+      }
+    }
+
+    if (--reader->rounds > 0)
+      Cown::schedule<Read>(reader, reader);
+  }
+};
+
+void test_readers(
+  size_t cores,
+  size_t readers,
+  size_t rounds,
+  size_t reads,
+  size_t updates,
+  bool borrow)
+{
+  Scheduler& sched = Scheduler::get();
+  sched.init(cores);
+
+  auto* alloc = ThreadAlloc::get();
+  Table* table = new Table(make_table(alloc, 0), updates);
+  Cown::schedule<Update>(table, table);
+
+  for (size_t i = 0; i < readers; i++)
+  {
+    auto r = new Reader(table, rounds, reads, borrow);
+    Cown::schedule<Read>(r, r);
+    Cown::release(alloc, r);
+  }
+  Cown::release(alloc, table);
+
+  auto start = std::chrono::steady_clock::now();
+  sched.run();
+  auto end = std::chrono::steady_clock::now();
+
+  double wall = std::chrono::duration<double>(end - start).count();
+  double total = (double)(readers * rounds * reads);
+
+  std::cout << (borrow ? "Borrow" : "Peek  ") << ": " << wall << " s, "
+            << (total / wall) << " reads/s" << std::endl;
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 8);
+  size_t readers = opt.is<size_t>("--readers", 256);
+  size_t rounds = opt.is<size_t>("--rounds", 100);
+  size_t reads = opt.is<size_t>("--reads", 100);
+  size_t updates = opt.is<size_t>("--updates", 1000);
+
+  test_readers(cores, readers, rounds, reads, updates, false);
+  test_readers(cores, readers, rounds, reads, updates, true);
+  return 0;
+}
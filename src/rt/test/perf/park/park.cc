@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include <chrono>
+#include <ctime>
+#include <test/opt.h>
+#include <thread>
+#include <verona.h>
+
+using namespace snmalloc;
+using namespace verona::rt;
+
+/**
+ * A thread outside the pool sends a trickle of behaviours, with gaps long
+ * enough for the scheduler threads to go idle. Reports how long each
+ * behaviour takes to start, and how much CPU the pool burns while it is
+ * mostly idle, for different amounts of spinning before parking.
+ **/
+struct Target : public VCown<Target>
+{};
+
+struct Latency
+{
+  std::atomic<uint64_t> total = 0;
+  std::atomic<uint64_t> worst = 0;
+  std::atomic<size_t> done = 0;
+};
+
+struct Ping : public VAction<Ping>
+{
+  uint64_t sent;
+  Latency* latency;
+
+  Ping(uint64_t sent, Latency* latency) : sent(sent), latency(latency) {}
+
+  void f()
+  {
+    uint64_t elapsed = Aal::tick() - sent;
+    latency->total += elapsed;
+
+    uint64_t worst = latency->worst;
+    while ((elapsed > worst) &&
+           !latency->worst.compare_exchange_weak(worst, elapsed))
+    {}
+
+    latency->done++;
+  }
+};
+
+void test_park(size_t cores, size_t rounds, size_t gap_us, uint64_t spin)
+{
+  Scheduler& sched = Scheduler::get();
+  Scheduler::set_park_spin(spin);
+
+  sched.init(cores);
+  Scheduler::set_allow_teardown(false);
+
+  Latency latency;
+  Cown* target = new Target;
+
+  std::thread sender([&]() {
+    for (size_t i = 0; i < rounds; i++)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+      Cown::schedule<Ping>(target, Aal::tick(), &latency);
+
+      while (latency.done <= i)
+        std::this_thread::yield();
+    }
+
+    Cown::release(ThreadAlloc::get(), target);
+    Scheduler::set_allow_teardown(true);
+  });
+
+  auto wall_start = std::chrono::steady_clock::now();
+  std::clock_t cpu_start = std::clock();
+
+  sched.run();
+  sender.join();
+
+  std::clock_t cpu_end = std::clock();
+  auto wall_end = std::chrono::steady_clock::now();
+
+  double wall = std::chrono::duration<double>(wall_end - wall_start).count();
+  double cpu = (double)(cpu_end - cpu_start) / CLOCKS_PER_SEC;
+
+  std::cout << "Park spin " << spin << " cycles, " << cores << " cores: "
+            << "mean wakeup " << (latency.total / rounds) << " cycles, "
+            << "worst " << latency.worst << " cycles, "
+            << "CPU " << (cpu / wall) << " cores busy" << std::endl;
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+
+  size_t cores = opt.is<size_t>("--cores", 8);
+  size_t rounds = opt.is<size_t>("--rounds", 2000);
+  size_t gap_us = opt.is<size_t>("--gap", 500);
+
+  test_park(cores, rounds, gap_us, 1'000'000);
+  test_park(cores, rounds, gap_us, 100'000);
+  test_park(cores, rounds, gap_us, 10'000);
+  return 0;
+}